@@ -0,0 +1,53 @@
+#include "args.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+std::string get_arg_param(const std::vector<std::string>& args, std::string_view expected_arg)
+{
+    auto itr = std::find(args.begin(), args.end(), expected_arg);
+    if (itr == args.end()) {
+        return "";
+    }
+    itr++;
+    if (itr == args.end()) {
+        return "";
+    }
+    std::string param = *itr;
+    if ((param.at(0) != '-') || (param == "-")) {
+        return param;
+    }
+    return "";
+}
+
+std::vector<std::string> get_arg_params(const std::vector<std::string>& args, std::string_view expected_arg)
+{
+    std::vector<std::string> params;
+    for (std::size_t i = 0; i + 1 < args.size(); i++) {
+        if ((args[i] == expected_arg) && !args[i + 1].empty() && (args[i + 1].at(0) != '-')) {
+            params.push_back(args[i + 1]);
+        }
+    }
+    return params;
+}
+
+std::string get_flag_value(const std::vector<std::string>& args, std::string_view flag)
+{
+    for (const std::string& arg : args) {
+        if ((arg.size() > flag.size()) && (arg.compare(0, flag.size(), flag) == 0) && (arg.at(flag.size()) == '=')) {
+            return arg.substr(flag.size() + 1);
+        }
+    }
+    return "";
+}
+
+std::vector<std::string> split(const std::string& s, const char delim)
+{
+    std::vector<std::string> result;
+    std::stringstream ss(s);
+    std::string token;
+    while (getline(ss, token, delim)) {
+        result.push_back(token);
+    }
+    return result;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Value following expected_arg ("-list words.txt"), or "" if it is missing
+// or looks like another option. A lone "-" (standard input) is a value.
+std::string get_arg_param(const std::vector<std::string>& args, std::string_view expected_arg);
+
+// Every value following expected_arg, for options that may be repeated
+// ("-guess crane:bybbb -guess pilot:bbgbb").
+std::vector<std::string> get_arg_params(const std::vector<std::string>& args, std::string_view expected_arg);
+
+// Value of a --name=value flag, or "" if the flag was not given.
+std::string get_flag_value(const std::vector<std::string>& args, std::string_view flag);
+
+std::vector<std::string> split(const std::string& s, const char delim);
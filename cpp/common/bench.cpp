@@ -0,0 +1,328 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+
+#include "args.hpp"
+#include "thread_pool.hpp"
+#include "word_index.hpp"
+
+namespace {
+
+// Relative frequency of 'a' ... 'z' in English text, in tenths of a percent.
+constexpr std::array<unsigned int, 26> LETTER_FREQUENCIES = {
+    82, 15, 28, 43, 127, 22, 20, 61, 70, 2, 8, 40, 24,
+    67, 75, 19, 1, 60, 63, 91, 28, 10, 24, 2, 20, 1,
+};
+
+// Default benchmark inputs and outputs, relative to the solver's directory.
+const char* const DEFAULT_WORD_LIST = "../../wordlewords.txt";
+const char* const DEFAULT_CORPUS = "bench/queries.txt";
+const char* const DEFAULT_RESULTS = "bench/latest.tsv";
+const char* const DEFAULT_BASELINE = "bench/baseline.tsv";
+constexpr std::size_t DEFAULT_SYNTHETIC_WORDS = 1000000;
+constexpr std::uint64_t SYNTHETIC_SEED = 20220101;
+
+// Slowdowns beyond this fraction of the baseline are reported as
+// regressions, unless --tolerance= says otherwise.
+constexpr double DEFAULT_TOLERANCE = 0.10;
+
+// "q1" on one thread, "q1@4" on four.
+std::string with_threads(const std::string& id, const std::size_t numThreads)
+{
+    return numThreads == 1 ? id : id + "@" + std::to_string(numThreads);
+}
+
+// 1, 2, 4, ... up to and including maxThreads.
+std::vector<std::size_t> scaling_thread_counts(const std::size_t maxThreads)
+{
+    std::vector<std::size_t> counts;
+    for (std::size_t n = 1; n < maxThreads; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+// Time build_index_image on the text of a word list, once per thread count.
+bool bench_parse(const std::string& wordFilePath, const std::string& listName,
+        const std::vector<std::size_t>& threadCounts, std::vector<BenchResult>& results, std::ostream& err)
+{
+    void* text = nullptr;
+    std::size_t size = 0;
+    if (!map_file(wordFilePath, text, size)) {
+        err << "Error when trying to open \"" << wordFilePath << "\".\n";
+        return false;
+    }
+    const std::size_t numLines = static_cast<std::size_t>(std::count(static_cast<const char*>(text),
+        static_cast<const char*>(text) + size, '\n'));
+    for (const std::size_t numThreads : threadCounts) {
+        BenchResult result{listName, "parse", with_threads("-", numThreads), numLines, 0, 0};
+        result.nanos = time_per_call([&] {
+            build_index_image(static_cast<const char*>(text), size, 0, 0, numThreads);
+        }, result.iterations);
+        results.push_back(result);
+    }
+    if (text != nullptr) {
+        ::munmap(text, size);
+    }
+    return true;
+}
+
+std::string file_name(const std::string& path)
+{
+    const std::size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+double per_word(const BenchResult& result)
+{
+    return result.words > 0 ? result.nanos / result.words : 0.0;
+}
+
+double per_second(const BenchResult& result)
+{
+    return result.nanos > 0 ? 1e9 / result.nanos : 0.0;
+}
+
+} // namespace
+
+bool read_bench_corpus(const std::string& corpusPath, std::vector<BenchQuery>& queries, std::ostream& err)
+{
+    std::ifstream corpusFile(corpusPath);
+    if (!corpusFile.is_open()) {
+        err << "Error when trying to open \"" << corpusPath << "\".\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(corpusFile, line)) {
+        std::istringstream tokens(line);
+        BenchQuery query;
+        if (!(tokens >> query.id) || (query.id.front() == '#')) {
+            continue;
+        }
+        std::string token;
+        while (tokens >> token) {
+            query.args.push_back(token);
+        }
+        queries.push_back(std::move(query));
+    }
+    return true;
+}
+
+bool write_synthetic_word_list(const std::string& path, const std::size_t numWords, const unsigned int length,
+        const std::uint64_t seed, std::ostream& err)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0) {
+        return true;
+    }
+
+    std::array<unsigned int, 26> cumulative;
+    unsigned int total = 0;
+    for (std::size_t c = 0; c < LETTER_FREQUENCIES.size(); c++) {
+        total += LETTER_FREQUENCIES[c];
+        cumulative[c] = total;
+    }
+
+    // mt19937_64 output is fully specified, unlike the standard distributions.
+    std::mt19937_64 random(seed);
+    std::string text;
+    text.reserve(numWords * (length + 1));
+    for (std::size_t w = 0; w < numWords; w++) {
+        for (unsigned int i = 0; i < length; i++) {
+            const unsigned int r = static_cast<unsigned int>(random() % total);
+            const std::size_t c = std::upper_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin();
+            text += static_cast<char>('a' + c);
+        }
+        text += '\n';
+    }
+
+    std::ofstream listFile(path, std::ios::binary);
+    if (!listFile.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+        err << "Error: Unable to write \"" << path << "\".\n";
+        return false;
+    }
+    return true;
+}
+
+void write_bench_results(const std::vector<BenchResult>& results, std::ostream& out)
+{
+    out << "list\tstage\tquery\twords\titerations\tns\tns_per_word\tqps\n";
+    for (const BenchResult& result : results) {
+        out << result.list << "\t" << result.stage << "\t" << result.query << "\t" << result.words << "\t"
+            << result.iterations << "\t" << result.nanos << "\t" << per_word(result) << "\t" << per_second(result) << "\n";
+    }
+}
+
+bool read_bench_results(const std::string& path, std::vector<BenchResult>& results)
+{
+    std::ifstream resultFile(path);
+    if (!resultFile.is_open()) {
+        return false;
+    }
+    std::string line;
+    std::getline(resultFile, line);
+    while (std::getline(resultFile, line)) {
+        std::istringstream fields(line);
+        BenchResult result;
+        if (std::getline(fields, result.list, '\t') && std::getline(fields, result.stage, '\t')
+                && std::getline(fields, result.query, '\t') && (fields >> result.words >> result.iterations >> result.nanos)) {
+            results.push_back(result);
+        }
+    }
+    return true;
+}
+
+void print_bench_summary(const std::vector<BenchResult>& results, std::ostream& out)
+{
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-24s %-12s %-8s %14s %12s %14s\n",
+        "list", "stage", "query", "us/iter", "ns/word", "per sec");
+    out << line;
+    for (const BenchResult& result : results) {
+        std::snprintf(line, sizeof(line), "%-24s %-12s %-8s %14.2f %12.2f %14.0f\n",
+            result.list.c_str(), result.stage.c_str(), result.query.c_str(),
+            result.nanos / 1000, per_word(result), per_second(result));
+        out << line;
+    }
+}
+
+void print_bench_scaling(const std::vector<BenchResult>& results, std::ostream& out)
+{
+    std::map<std::tuple<std::string, std::string, std::string>, double> singleThreadNanos;
+    for (const BenchResult& result : results) {
+        if (result.query.find('@') == std::string::npos) {
+            singleThreadNanos[std::make_tuple(result.list, result.stage, result.query)] = result.nanos;
+        }
+    }
+
+    char line[160];
+    for (const BenchResult& result : results) {
+        const std::size_t at = result.query.find('@');
+        if (at == std::string::npos) {
+            continue;
+        }
+        const auto found = singleThreadNanos.find(std::make_tuple(result.list, result.stage, result.query.substr(0, at)));
+        if ((found == singleThreadNanos.end()) || (result.nanos <= 0)) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%-24s %-12s %-8s %8.2fx\n",
+            result.list.c_str(), result.stage.c_str(), result.query.c_str(), found->second / result.nanos);
+        out << line;
+    }
+}
+
+std::size_t compare_bench_results(const std::vector<BenchResult>& results,
+        const std::vector<BenchResult>& baseline, const double tolerance, std::ostream& out)
+{
+    std::map<std::tuple<std::string, std::string, std::string>, double> baselineNanos;
+    for (const BenchResult& result : baseline) {
+        baselineNanos[std::make_tuple(result.list, result.stage, result.query)] = result.nanos;
+    }
+
+    std::size_t numRegressions = 0;
+    char line[160];
+    for (const BenchResult& result : results) {
+        const auto found = baselineNanos.find(std::make_tuple(result.list, result.stage, result.query));
+        if ((found == baselineNanos.end()) || (found->second <= 0)) {
+            continue;
+        }
+        const double ratio = result.nanos / found->second;
+        const bool regressed = ratio > 1.0 + tolerance;
+        numRegressions += regressed;
+        std::snprintf(line, sizeof(line), "%-24s %-12s %-8s %+9.1f%%%s\n",
+            result.list.c_str(), result.stage.c_str(), result.query.c_str(),
+            100.0 * (ratio - 1.0), regressed ? "  REGRESSION" : "");
+        out << line;
+    }
+    return numRegressions;
+}
+
+int run_benchmark(const std::vector<std::string>& args, const BenchWordList& benchWordList,
+        std::ostream& out, std::ostream& err)
+{
+    const std::string wordFilePathParam = get_arg_param(args, "-list");
+    const std::string corpusParam = get_arg_param(args, "-corpus");
+    const std::string syntheticParam = get_arg_param(args, "-synthetic");
+    const std::string resultsParam = get_arg_param(args, "-o");
+    const std::string baselineParam = get_flag_value(args, "--baseline");
+    const std::string toleranceParam = get_flag_value(args, "--tolerance");
+    const std::string threadsParam = get_arg_param(args, "-threads");
+    const std::string wordFilePath = wordFilePathParam != "" ? wordFilePathParam : DEFAULT_WORD_LIST;
+    const std::string resultsPath = resultsParam != "" ? resultsParam : DEFAULT_RESULTS;
+    const std::string baselinePath = baselineParam != "" ? baselineParam : DEFAULT_BASELINE;
+    const std::size_t numSynthetic = syntheticParam != ""
+        ? std::strtoul(syntheticParam.c_str(), nullptr, 10) : DEFAULT_SYNTHETIC_WORDS;
+
+    const std::size_t maxThreads = threadsParam != ""
+        ? std::max<std::size_t>(1, std::strtoul(threadsParam.c_str(), nullptr, 10)) : default_thread_count();
+    const double tolerance = toleranceParam != "" ? std::strtod(toleranceParam.c_str(), nullptr) : DEFAULT_TOLERANCE;
+
+    std::vector<BenchQuery> queries;
+    if (!read_bench_corpus(corpusParam != "" ? corpusParam : DEFAULT_CORPUS, queries, err)) {
+        return EXIT_FAILURE;
+    }
+    // Every query runs on 1, 2, 4, ... maxThreads threads, for the scaling.
+    const std::vector<std::size_t> threadCounts = scaling_thread_counts(maxThreads);
+    std::vector<BenchQuery> corpus;
+    for (const BenchQuery& query : queries) {
+        for (const std::size_t numThreads : threadCounts) {
+            BenchQuery threaded{with_threads(query.id, numThreads), query.args};
+            threaded.args.push_back("-threads");
+            threaded.args.push_back(std::to_string(numThreads));
+            corpus.push_back(std::move(threaded));
+        }
+    }
+
+    std::vector<std::string> wordFilePaths = {wordFilePath};
+    if (numSynthetic > 0) {
+        // Kept next to the results so its index is built only once.
+        const std::size_t slash = resultsPath.find_last_of('/');
+        const std::string directory = slash == std::string::npos ? "" : resultsPath.substr(0, slash + 1);
+        wordFilePaths.push_back(directory + "synthetic_" + std::to_string(numSynthetic) + ".txt");
+        if (!write_synthetic_word_list(wordFilePaths.back(), numSynthetic, 5, SYNTHETIC_SEED, err)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    for (const std::string& path : wordFilePaths) {
+        if (!bench_parse(path, file_name(path), threadCounts, results, err)
+                || !benchWordList(path, file_name(path), corpus, results, err)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ofstream resultsFile(resultsPath);
+    write_bench_results(results, resultsFile);
+    if (!resultsFile) {
+        err << "Error: Unable to write \"" << resultsPath << "\".\n";
+        return EXIT_FAILURE;
+    }
+    print_bench_summary(results, out);
+    if (maxThreads > 1) {
+        out << "\nSpeedup over one thread:\n";
+        print_bench_scaling(results, out);
+    }
+    out << "\nResults written to " << resultsPath << ".\n";
+
+    std::vector<BenchResult> baseline;
+    if (!read_bench_results(baselinePath, baseline)) {
+        out << "No baseline at " << baselinePath << " (save one with make bench-save).\n";
+        return EXIT_SUCCESS;
+    }
+    out << "\nChange from " << baselinePath << ":\n";
+    const std::size_t numRegressions = compare_bench_results(results, baseline, tolerance, out);
+    out << numRegressions << " regression(s) beyond " << (100 * tolerance) << "%.\n";
+    return numRegressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// One measurement: a stage of one query (or of the whole list) on one word
+// list, e.g. ("wordlewords.txt", "filter", "q3").
+struct BenchResult {
+    std::string list;
+    std::string stage;
+    std::string query;
+    // Words processed per iteration, for ns/word.
+    std::size_t words = 0;
+    std::size_t iterations = 0;
+    // Mean time per iteration.
+    double nanos = 0;
+};
+
+// A query of the benchmark corpus: an ID followed by the usual arguments.
+struct BenchQuery {
+    std::string id;
+    std::vector<std::string> args;
+};
+
+// One measurement is taken in BENCH_ROUNDS rounds of at least
+// MIN_ROUND_SECONDS each; the fastest round counts, which filters out most
+// interference from other processes.
+constexpr std::size_t BENCH_ROUNDS = 5;
+constexpr double MIN_ROUND_SECONDS = 0.04;
+
+// Call fn repeatedly (at least once per round) and return the mean time per
+// call of the fastest round in nanoseconds. iterations is the total count.
+template <typename Fn>
+double time_per_call(const Fn& fn, std::size_t& iterations)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto minRound = std::chrono::duration<double>(MIN_ROUND_SECONDS);
+    double best = 0;
+    iterations = 0;
+    for (std::size_t round = 0; round < BENCH_ROUNDS; round++) {
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        std::size_t calls = 0;
+        do {
+            fn();
+            calls++;
+            elapsed = Clock::now() - start;
+        } while (elapsed < minRound);
+        const double nanos = std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+        best = (round == 0) ? nanos : std::min(best, nanos);
+        iterations += calls;
+    }
+    return best;
+}
+
+// Read a corpus: one "<id> <args...>" per line; blank and # lines are skipped.
+bool read_bench_corpus(const std::string& corpusPath, std::vector<BenchQuery>& queries, std::ostream& err);
+
+// Write numWords random words of the given length to path, unless the file
+// already exists. Letters follow English letter frequencies and the same
+// seed always gives the same list.
+bool write_synthetic_word_list(const std::string& path, std::size_t numWords, unsigned int length,
+        std::uint64_t seed, std::ostream& err);
+
+// Tab-separated, one result per line after a header line:
+// list stage query words iterations ns ns_per_word qps
+void write_bench_results(const std::vector<BenchResult>& results, std::ostream& out);
+bool read_bench_results(const std::string& path, std::vector<BenchResult>& results);
+
+// The same results as an aligned table.
+void print_bench_summary(const std::vector<BenchResult>& results, std::ostream& out);
+
+// Speedup of every result measured on several threads ("q1@4") over the
+// same measurement on one thread ("q1").
+void print_bench_scaling(const std::vector<BenchResult>& results, std::ostream& out);
+
+// Compare every result with the baseline result for the same list, stage
+// and query. Slowdowns beyond tolerance (0.1 = 10%) are flagged; returns
+// how many there were.
+std::size_t compare_bench_results(const std::vector<BenchResult>& results,
+        const std::vector<BenchResult>& baseline, double tolerance, std::ostream& out);
+
+// Measures the solver-specific stages (loading, then each query of the
+// corpus) on one word list, appending to results.
+using BenchWordList = std::function<bool(const std::string& wordFilePath, const std::string& listName,
+        const std::vector<BenchQuery>& corpus, std::vector<BenchResult>& results, std::ostream& err)>;
+
+// Bench mode, shared by both solvers:
+//   wordle_solver bench [-list words.txt] [-corpus bench/queries.txt]
+//       [-synthetic 1000000] [-o bench/latest.tsv] [--baseline=bench/baseline.tsv]
+//       [--tolerance=0.1] [-threads N]
+// Times parsing the word list and everything benchWordList measures, on the
+// word list and on a synthetic list of that many words (0: none), on 1, 2,
+// 4, ... N threads (default: one per core), writes the results to the -o
+// file and prints them with the speedups, compared with the baseline if
+// there is one. Fails if any result regressed beyond the tolerance.
+int run_benchmark(const std::vector<std::string>& args, const BenchWordList& benchWordList,
+        std::ostream& out, std::ostream& err);
@@ -0,0 +1,22 @@
+#include "word_index.hpp"
+
+#include <chrono>
+
+// Generated at build time by tools/embed_word_list.cpp: the index image of
+// the bundled word list as EMBEDDED_INDEX, or EMBEDDED_INDEX_SIZE 0 if the
+// binary was built without one (make EMBED_LIST=).
+#include "embedded_index.inc"
+
+bool load_bundled_word_list(WordIndex& index, const std::size_t numThreads, LoadStats& stats, std::ostream& err)
+{
+    const auto openStart = std::chrono::steady_clock::now();
+    if ((EMBEDDED_INDEX_SIZE > 0)
+            && index.attach(reinterpret_cast<const char*>(EMBEDDED_INDEX), EMBEDDED_INDEX_SIZE)) {
+        stats = LoadStats();
+        stats.embedded = true;
+        stats.openMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - openStart)
+            .count();
+        return true;
+    }
+    return load_word_list(BUNDLED_WORD_LIST, index, numThreads, stats, err);
+}
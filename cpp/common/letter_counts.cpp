@@ -0,0 +1,202 @@
+#include "letter_counts.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "parallel.hpp"
+
+namespace {
+
+// Smaller tables are counted on one thread.
+constexpr std::size_t MIN_COUNT_WORDS_PER_THREAD = 1 << 16;
+constexpr unsigned int FIELD_BITS = 4;
+constexpr std::size_t FIELDS_PER_HALF = 16;
+constexpr std::uint64_t FIELD_MASK = 7;
+
+std::uint64_t& half_of(LetterCounts& counts, const std::size_t c)
+{
+    return c < FIELDS_PER_HALF ? counts.lo : counts.hi;
+}
+
+std::uint64_t half_of(const LetterCounts& counts, const std::size_t c)
+{
+    return c < FIELDS_PER_HALF ? counts.lo : counts.hi;
+}
+
+unsigned int shift_of(const std::size_t c)
+{
+    return FIELD_BITS * (c % FIELDS_PER_HALF);
+}
+
+unsigned int get_field(const LetterCounts& counts, const std::size_t c)
+{
+    return static_cast<unsigned int>((half_of(counts, c) >> shift_of(c)) & FIELD_MASK);
+}
+
+void set_field(LetterCounts& counts, const std::size_t c, const unsigned int value)
+{
+    std::uint64_t& half = half_of(counts, c);
+    half = (half & ~(FIELD_MASK << shift_of(c))) | (static_cast<std::uint64_t>(value) << shift_of(c));
+}
+
+} // namespace
+
+LetterCounts count_letters(const char* word, const std::size_t length)
+{
+    // A letter of a word of up to 7 letters occurs at most 7 times, so only
+    // longer words need the saturating add. The half is picked with masks:
+    // a branch on the letter would be mispredicted half the time.
+    LetterCounts counts;
+    for (std::size_t i = 0; i < length; i++) {
+        const std::size_t c = word[i] - 'a';
+        const std::uint64_t inHi = static_cast<std::uint64_t>(c < FIELDS_PER_HALF) - 1;
+        std::uint64_t one = std::uint64_t{1} << shift_of(c);
+        if (length > MAX_LETTER_COUNT) {
+            const std::uint64_t half = (counts.lo & ~inHi) | (counts.hi & inHi);
+            one &= static_cast<std::uint64_t>(((half >> shift_of(c)) & FIELD_MASK) == MAX_LETTER_COUNT) - 1;
+        }
+        counts.lo += one & ~inHi;
+        counts.hi += one & inHi;
+    }
+    return counts;
+}
+
+std::vector<LetterCounts> count_letters(const WordTable& words, const std::size_t numThreads)
+{
+    std::vector<LetterCounts> counts(words.count);
+    const std::size_t usefulThreads = std::max<std::size_t>(1, words.count / MIN_COUNT_WORDS_PER_THREAD);
+    parallel_for(words.count, std::min(numThreads, usefulThreads), [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t w = begin; w < end; w++) {
+            counts[w] = count_letters(words.data + (w * words.length), words.length);
+        }
+    });
+    return counts;
+}
+
+CountQuery::CountQuery()
+{
+    for (std::size_t c = 0; c < 26; c++) {
+        set_field(maxCounts, c, MAX_LETTER_COUNT);
+    }
+}
+
+void CountQuery::bound(const std::size_t c, const unsigned int min, const unsigned int max)
+{
+    set_field(minCounts, c, std::max(min_count(c), std::min(min, MAX_LETTER_COUNT)));
+    set_field(maxCounts, c, std::min(max_count(c), std::min(max, MAX_LETTER_COUNT)));
+}
+
+unsigned int CountQuery::min_count(const std::size_t c) const
+{
+    return get_field(minCounts, c);
+}
+
+unsigned int CountQuery::max_count(const std::size_t c) const
+{
+    return get_field(maxCounts, c);
+}
+
+bool CountQuery::bounded() const
+{
+    const CountQuery unbounded;
+    return (minCounts.lo != 0) || (minCounts.hi != 0) || (maxCounts.lo != unbounded.maxCounts.lo)
+        || (maxCounts.hi != unbounded.maxCounts.hi);
+}
+
+std::uint32_t CountQuery::required_letters() const
+{
+    std::uint32_t letters = 0;
+    for (std::size_t c = 0; c < 26; c++) {
+        letters |= static_cast<std::uint32_t>(min_count(c) > 0) << c;
+    }
+    return letters;
+}
+
+std::uint32_t CountQuery::excluded_letters() const
+{
+    std::uint32_t letters = 0;
+    for (std::size_t c = 0; c < 26; c++) {
+        letters |= static_cast<std::uint32_t>(max_count(c) == 0) << c;
+    }
+    return letters;
+}
+
+bool parse_count_query(const std::string& param, CountQuery& query, std::string& error)
+{
+    std::size_t start = 0;
+    while (start <= param.length()) {
+        const std::size_t end = std::min(param.find(',', start), param.length());
+        const std::string entry = param.substr(start, end - start);
+        start = end + 1;
+
+        // <letter><op><count> with op one of =, <= and >=
+        const std::size_t opLength = (entry.length() > 2) && (entry[2] == '=') ? 2 : 1;
+        const std::string op = entry.substr(1, opLength);
+        const std::string count = entry.length() > opLength + 1 ? entry.substr(opLength + 1) : "";
+        if ((entry.length() < 3) || (entry[0] < 'a') || (entry[0] > 'z') || ((op != "=") && (op != "<=") && (op != ">="))
+                || count.empty() || (count.length() > 2)
+                || (count.find_first_not_of("0123456789") != std::string::npos)) {
+            error = "Expected -count <letter><op><count> with op =, <= or >=, e.g. -count e=2,a<=1,s>=1.";
+            return false;
+        }
+        const unsigned int n = static_cast<unsigned int>(std::stoul(count));
+        if (n > MAX_LETTER_COUNT) {
+            error = "Letter counts above " + std::to_string(MAX_LETTER_COUNT) + " are not supported.";
+            return false;
+        }
+        const std::size_t c = entry[0] - 'a';
+        query.bound(c, op == "<=" ? 0 : n, op == ">=" ? MAX_LETTER_COUNT : n);
+        if (query.min_count(c) > query.max_count(c)) {
+            error = std::string("The -count bounds on '") + entry[0] + "' contradict each other.";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parse_anagram(const std::string& letters, CountQuery& query, std::string& error)
+{
+    if ((letters.length() < MIN_WORD_LENGTH) || (letters.length() > MAX_WORD_LENGTH)) {
+        error = "-anagram must have between " + std::to_string(MIN_WORD_LENGTH) + " and "
+            + std::to_string(MAX_WORD_LENGTH) + " letters.";
+        return false;
+    }
+    std::array<unsigned int, 26> given{};
+    unsigned int numBlanks = 0;
+    for (const char c : letters) {
+        if (c == '?') {
+            numBlanks++;
+        } else if ((c >= 'a') && (c <= 'z')) {
+            given[c - 'a']++;
+        } else {
+            error = "-anagram may only contain lowercase letters and '?'.";
+            return false;
+        }
+    }
+    // With the length fixed, the minimums alone already leave exactly the
+    // blanks free; the maximums let the presence tests reject early.
+    for (std::size_t c = 0; c < 26; c++) {
+        query.bound(c, given[c], given[c] + numBlanks);
+    }
+    return true;
+}
+
+void narrow_by_counts(const LetterCounts* counts, const CountQuery& query, std::vector<std::uint32_t>& candidates)
+{
+    std::size_t numKept = 0;
+    for (const std::uint32_t w : candidates) {
+        candidates[numKept] = w;
+        numKept += query.matches(counts[w]);
+    }
+    candidates.resize(numKept);
+}
+
+void narrow_by_counts(const WordTable& words, const CountQuery& query, std::vector<std::uint32_t>& candidates)
+{
+    std::size_t numKept = 0;
+    for (const std::uint32_t w : candidates) {
+        candidates[numKept] = w;
+        numKept += query.matches(count_letters(words.data + (w * words.length), words.length));
+    }
+    candidates.resize(numKept);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "word_index.hpp"
+
+// Counts above this are stored as this: -count bounds may not exceed it.
+constexpr unsigned int MAX_LETTER_COUNT = 7;
+
+// How often each letter occurs in a word, as 26 4-bit fields: 'a' to 'p'
+// in lo, 'q' to 'z' in hi. The low 3 bits of a field hold the count; the
+// top bit stays clear as a guard, so that one subtraction compares all the
+// fields of a half at once without a borrow crossing into the next field.
+struct LetterCounts {
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+};
+
+// The counts of one word of lowercase letters.
+LetterCounts count_letters(const char* word, std::size_t length);
+
+// The counts of every word of a table, in table order, on up to numThreads
+// threads for large tables.
+std::vector<LetterCounts> count_letters(const WordTable& words, std::size_t numThreads);
+
+// Bounds on how often each letter occurs, from -count or -anagram.
+struct CountQuery {
+    // Per-letter fields as in LetterCounts: 0 and MAX_LETTER_COUNT where a
+    // letter is not bounded.
+    LetterCounts minCounts;
+    LetterCounts maxCounts;
+
+    CountQuery();
+
+    // Narrow the bounds of letter 'a' + c to [min, max] (intersected with
+    // any earlier bounds).
+    void bound(std::size_t c, unsigned int min, unsigned int max);
+    unsigned int min_count(std::size_t c) const;
+    unsigned int max_count(std::size_t c) const;
+
+    // True if any letter is bounded, i.e. some word can be rejected.
+    bool bounded() const;
+    // Letters that must occur (min >= 1) and must not (max == 0), as
+    // bitmasks for the cheaper presence tests.
+    std::uint32_t required_letters() const;
+    std::uint32_t excluded_letters() const;
+
+    // Every letter within its bounds: two subtractions per half, whose
+    // guard bits survive exactly in the fields that are in range.
+    bool matches(const LetterCounts& counts) const
+    {
+        constexpr std::uint64_t GUARDS = 0x8888888888888888;
+        const std::uint64_t lo = ((counts.lo | GUARDS) - minCounts.lo) & ((maxCounts.lo | GUARDS) - counts.lo);
+        const std::uint64_t hi = ((counts.hi | GUARDS) - minCounts.hi) & ((maxCounts.hi | GUARDS) - counts.hi);
+        return (lo & hi & GUARDS) == GUARDS;
+    }
+};
+
+// Parse -count bounds, e.g. "e=2,a<=1,s>=1", into query. Bounds on the same
+// letter are intersected.
+bool parse_count_query(const std::string& param, CountQuery& query, std::string& error);
+
+// Parse an -anagram, e.g. "listen" or "list??" with '?' for any letter,
+// into query. Together with a word length of letters.length() it matches
+// exactly the rearrangements of the letters.
+bool parse_anagram(const std::string& letters, CountQuery& query, std::string& error);
+
+// Keep the candidates (indices into counts) that satisfy query, in order.
+void narrow_by_counts(const LetterCounts* counts, const CountQuery& query, std::vector<std::uint32_t>& candidates);
+
+// The same for a table without precomputed counts: each candidate is
+// counted as it is tested.
+void narrow_by_counts(const WordTable& words, const CountQuery& query, std::vector<std::uint32_t>& candidates);
@@ -0,0 +1,47 @@
+#include "letter_rank.hpp"
+
+#include <algorithm>
+#include <array>
+
+std::vector<RankedWord> rank_by_letter_frequency(const WordTable& words,
+        const std::vector<std::uint32_t>& candidates, const std::size_t count)
+{
+    const std::size_t length = words.length;
+
+    // One pass over the candidates for both histograms. A letter counts as
+    // present at its first occurrence in the word; that test is a mask
+    // rather than a branch, which would be mispredicted on every repeat.
+    std::array<std::array<std::uint32_t, 26>, MAX_WORD_LENGTH> positionCounts{};
+    std::array<std::uint32_t, 26> presenceCounts{};
+    for (const std::uint32_t candidate : candidates) {
+        const char* word = words.data + (candidate * length);
+        std::uint32_t seen = 0;
+        for (std::size_t i = 0; i < length; i++) {
+            const std::size_t c = word[i] - 'a';
+            positionCounts[i][c]++;
+            presenceCounts[c] += ((seen >> c) & 1) ^ 1;
+            seen |= 1u << c;
+        }
+    }
+
+    std::vector<RankedWord> ranked(candidates.size());
+    for (std::size_t k = 0; k < candidates.size(); k++) {
+        const char* word = words.data + (candidates[k] * length);
+        std::uint32_t score = 0;
+        std::uint32_t seen = 0;
+        for (std::size_t i = 0; i < length; i++) {
+            const std::size_t c = word[i] - 'a';
+            score += positionCounts[i][c] + (presenceCounts[c] & (((seen >> c) & 1) - 1));
+            seen |= 1u << c;
+        }
+        ranked[k] = {candidates[k], score};
+    }
+
+    const std::size_t numBest = std::min(count, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + numBest, ranked.end(),
+        [](const RankedWord& a, const RankedWord& b) {
+            return (a.score != b.score) ? (a.score > b.score) : (a.index < b.index);
+        });
+    ranked.resize(numBest);
+    return ranked;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "word_index.hpp"
+
+// A candidate and how common its letters are among all the candidates.
+struct RankedWord {
+    std::uint32_t index;
+    std::uint32_t score;
+};
+
+// Score every candidate (an index into words) by the letter frequencies of
+// the candidates themselves: for each position, how many candidates have
+// the same letter there, plus, for each distinct letter of the word, how
+// many candidates contain it. Words sharing the most letters with the
+// others come first, as they tell the most apart when guessed.
+// Returns the best `count` (all of them if count is larger), best first,
+// ties in word list order. Only the best `count` are sorted.
+std::vector<RankedWord> rank_by_letter_frequency(const WordTable& words,
+        const std::vector<std::uint32_t>& candidates, std::size_t count);
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Split [0, count) into numThreads contiguous ranges and call
+// fn(begin, end) for each on its own thread (the calling thread takes the
+// first range). Returns once every range is done.
+template <typename Fn>
+void parallel_for(const std::size_t count, std::size_t numThreads, const Fn& fn)
+{
+    numThreads = std::max<std::size_t>(1, std::min(numThreads, count));
+    const std::size_t chunk = (count + numThreads - 1) / numThreads;
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < numThreads; t++) {
+        const std::size_t begin = std::min(count, t * chunk);
+        const std::size_t end = std::min(count, begin + chunk);
+        threads.emplace_back([&fn, begin, end] { fn(begin, end); });
+    }
+    fn(0, std::min(count, chunk));
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Like parallel_for, but load-balanced for work of uneven cost: every
+// thread starts on its own contiguous range and repeatedly takes the next
+// `grain` indices from its front; a thread whose range runs dry steals the
+// back half of the largest range left. fn(begin, end) may therefore be
+// called many times per thread, always with disjoint ranges.
+template <typename Fn>
+void parallel_for_dynamic(const std::size_t count, std::size_t numThreads, std::size_t grain, const Fn& fn)
+{
+    struct alignas(64) WorkRange {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    grain = std::max<std::size_t>(1, grain);
+    numThreads = std::max<std::size_t>(1, std::min(numThreads, (count + grain - 1) / grain));
+    std::vector<WorkRange> ranges(numThreads);
+    const std::size_t chunk = (count + numThreads - 1) / numThreads;
+    for (std::size_t t = 0; t < numThreads; t++) {
+        ranges[t].begin = std::min(count, t * chunk);
+        ranges[t].end = std::min(count, ranges[t].begin + chunk);
+    }
+
+    const auto work = [&ranges, &fn, grain, numThreads](const std::size_t self) {
+        WorkRange& own = ranges[self];
+        for (;;) {
+            std::size_t begin = 0;
+            std::size_t end = 0;
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                begin = own.begin;
+                end = std::min(own.end, begin + grain);
+                own.begin = end;
+            }
+            if (begin < end) {
+                fn(begin, end);
+                continue;
+            }
+
+            // Out of work: steal the back half of the fullest other range.
+            std::size_t victim = numThreads;
+            std::size_t victimSize = 0;
+            for (std::size_t t = 0; t < numThreads; t++) {
+                if (t == self) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(ranges[t].mutex);
+                const std::size_t size = ranges[t].end - ranges[t].begin;
+                if (size > victimSize) {
+                    victim = t;
+                    victimSize = size;
+                }
+            }
+            if (victim == numThreads) {
+                return;
+            }
+            std::size_t stolenBegin = 0;
+            std::size_t stolenEnd = 0;
+            {
+                std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                const std::size_t size = ranges[victim].end - ranges[victim].begin;
+                stolenEnd = ranges[victim].end;
+                stolenBegin = stolenEnd - (size - (size / 2));
+                ranges[victim].end = stolenBegin;
+            }
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = stolenBegin;
+            own.end = stolenEnd;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < numThreads; t++) {
+        threads.emplace_back(work, t);
+    }
+    work(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Run a filter over [0, count) split into contiguous ranges of at least
+// minPerThread items, one range per thread, and merge the results in
+// order. filter(begin, end, out) writes the matching indices of
+// [begin, end), relative to begin, to out and returns how many there were.
+// out must have room for count entries; on return it holds the matching
+// indices of [0, count) exactly as one sequential call would have written
+// them, and the number of matches is returned.
+template <typename Filter>
+std::size_t parallel_filter(const std::size_t count, std::size_t numThreads, const std::size_t minPerThread,
+        std::uint32_t* out, const Filter& filter)
+{
+    numThreads = std::max<std::size_t>(1, std::min(numThreads, count / std::max<std::size_t>(1, minPerThread)));
+    if (numThreads == 1) {
+        return filter(0, count, out);
+    }
+
+    // Ranges start on a multiple of 64 items, so vector kernels see aligned slices.
+    const std::size_t chunk = (((count + numThreads - 1) / numThreads) + 63) & ~static_cast<std::size_t>(63);
+    std::vector<std::size_t> counts(numThreads, 0);
+    parallel_for(numThreads, numThreads, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t t = first; t < last; t++) {
+            const std::size_t begin = std::min(count, t * chunk);
+            const std::size_t end = std::min(count, begin + chunk);
+            counts[t] = (begin < end) ? filter(begin, end, out + begin) : 0;
+        }
+    });
+
+    // Every range's results move down to directly after the previous one's.
+    std::size_t total = counts[0];
+    for (std::size_t t = 1; t < numThreads; t++) {
+        const std::size_t begin = t * chunk;
+        for (std::size_t i = 0; i < counts[t]; i++) {
+            out[total + i] = out[begin + i] + static_cast<std::uint32_t>(begin);
+        }
+        total += counts[t];
+    }
+    return total;
+}
@@ -0,0 +1,338 @@
+#include "query_server.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "thread_pool.hpp"
+
+namespace {
+
+// Percentiles are taken over this many of the most recent requests.
+constexpr std::size_t RECENT_LATENCIES = 4096;
+
+class LatencyStats {
+public:
+    void record(const double micros, const bool failed)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests++;
+        errors += failed;
+        totalMicros += micros;
+        maxMicros = std::max(maxMicros, micros);
+        if (recent.size() < RECENT_LATENCIES) {
+            recent.push_back(micros);
+        } else {
+            recent[requests % RECENT_LATENCIES] = micros;
+        }
+    }
+
+    std::vector<std::string> report() const
+    {
+        std::vector<double> sorted;
+        std::vector<std::string> lines;
+        std::lock_guard<std::mutex> lock(mutex);
+        sorted = recent;
+        std::sort(sorted.begin(), sorted.end());
+        const auto percentile = [&sorted](const double p) {
+            return sorted.empty() ? 0.0 : sorted[static_cast<std::size_t>(p * (sorted.size() - 1))];
+        };
+        lines.push_back("requests " + std::to_string(requests));
+        lines.push_back("errors " + std::to_string(errors));
+        lines.push_back("latency_us_mean " + std::to_string(requests > 0 ? totalMicros / requests : 0.0));
+        lines.push_back("latency_us_p50 " + std::to_string(percentile(0.50)));
+        lines.push_back("latency_us_p99 " + std::to_string(percentile(0.99)));
+        lines.push_back("latency_us_max " + std::to_string(maxMicros));
+        return lines;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::uint64_t requests = 0;
+    std::uint64_t errors = 0;
+    double totalMicros = 0;
+    double maxMicros = 0;
+    std::vector<double> recent;
+};
+
+void append_lines(const std::string& text, std::vector<std::string>& lines)
+{
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(line);
+    }
+}
+
+std::string format_response(const bool ok, const std::vector<std::string>& lines, const double micros)
+{
+    std::string response = ok ? "ok " : "error ";
+    response += std::to_string(lines.size()) + " " + std::to_string(micros) + "\n";
+    for (const std::string& line : lines) {
+        response += line;
+        response += '\n';
+    }
+    return response;
+}
+
+// Answer one request line. Returns "" for blank lines and for "quit",
+// which also sets quit.
+std::string answer(const std::string& request, const QueryHandler& handler, LatencyStats& stats, bool& quit)
+{
+    std::vector<std::string> args;
+    std::istringstream tokens(request);
+    std::string token;
+    while (tokens >> token) {
+        args.push_back(token);
+    }
+    if (args.empty()) {
+        return "";
+    }
+    if ((args.size() == 1) && (args.front() == "quit")) {
+        quit = true;
+        return "";
+    }
+    if ((args.size() == 1) && (args.front() == "stats")) {
+        return format_response(true, stats.report(), 0);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::ostringstream out;
+    std::ostringstream err;
+    int status = EXIT_FAILURE;
+    try {
+        status = handler(args, out, err);
+    } catch (const std::exception& ex) {
+        err << "Error: " << ex.what() << "\n";
+    }
+    const double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    const bool ok = status == EXIT_SUCCESS;
+    stats.record(micros, !ok);
+
+    std::vector<std::string> lines;
+    if (ok) {
+        append_lines(out.str(), lines);
+    }
+    append_lines(err.str(), lines);
+    return format_response(ok, lines, micros);
+}
+
+bool write_all(const int fd, const std::string& data)
+{
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// One socket client. Its pending input is read by the accept loop while
+// the connection is idle and answered by a worker while it is busy, so
+// the two never touch it at the same time.
+struct Connection {
+    int fd = -1;
+    QueryHandler handler;
+    std::string pending;
+    // A worker is answering the complete lines of pending.
+    bool busy = false;
+    // The client quit or could not be written to.
+    bool closed = false;
+};
+
+// Worker task: answer every complete line of the connection's input.
+void answer_lines(Connection& connection, LatencyStats& stats)
+{
+    std::size_t lineStart = 0;
+    std::size_t newline = 0;
+    bool quit = false;
+    while (!quit && ((newline = connection.pending.find('\n', lineStart)) != std::string::npos)) {
+        const std::string response =
+            answer(connection.pending.substr(lineStart, newline - lineStart), connection.handler, stats, quit);
+        lineStart = newline + 1;
+        if (!response.empty() && !write_all(connection.fd, response)) {
+            quit = true;
+        }
+    }
+    connection.pending.erase(0, lineStart);
+    connection.closed = quit;
+}
+
+int serve_stdio(const SessionFactory& newSession)
+{
+    const QueryHandler handler = newSession();
+    LatencyStats stats;
+    std::string line;
+    bool quit = false;
+    while (!quit && std::getline(std::cin, line)) {
+        std::cout << answer(line, handler, stats, quit) << std::flush;
+    }
+    return EXIT_SUCCESS;
+}
+
+int serve_socket(const std::string& socketPath, const std::size_t numThreads, const SessionFactory& newSession)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: The socket path \"" << socketPath << "\" is too long.\n";
+        return EXIT_FAILURE;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Error: Unable to create a socket: " << std::strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+    ::unlink(socketPath.c_str());
+    if ((::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            || (::listen(listener, SOMAXCONN) != 0)) {
+        std::cerr << "Error: Unable to listen on \"" << socketPath << "\": " << std::strerror(errno) << "\n";
+        ::close(listener);
+        return EXIT_FAILURE;
+    }
+    std::cerr << "Listening on " << socketPath << " with " << numThreads << " worker threads.\n";
+
+    std::signal(SIGPIPE, SIG_IGN);
+    // Workers write a byte here when they finish with a connection, so
+    // that the loop below polls it again.
+    int wake[2];
+    if (::pipe(wake) != 0) {
+        std::cerr << "Error: Unable to create a pipe: " << std::strerror(errno) << "\n";
+        ::close(listener);
+        return EXIT_FAILURE;
+    }
+
+    // Connections only hold a worker while a request is being answered,
+    // so any number of clients can stay connected to numThreads workers.
+    LatencyStats stats;
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Connection>> connections;
+    {
+        // Joined before the pipe and the connections are closed.
+        ThreadPool pool(numThreads);
+        std::vector<pollfd> polled;
+        std::vector<std::shared_ptr<Connection>> idle;
+        for (;;) {
+            polled = {{listener, POLLIN, 0}, {wake[0], POLLIN, 0}};
+            idle.clear();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (std::size_t c = 0; c < connections.size();) {
+                    Connection& connection = *connections[c];
+                    if (!connection.busy && connection.closed) {
+                        ::close(connection.fd);
+                        connections.erase(connections.begin() + static_cast<std::ptrdiff_t>(c));
+                        continue;
+                    }
+                    if (!connection.busy) {
+                        idle.push_back(connections[c]);
+                        polled.push_back({connection.fd, POLLIN, 0});
+                    }
+                    c++;
+                }
+            }
+            if (::poll(polled.data(), polled.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "Error: Unable to poll the connections: " << std::strerror(errno) << "\n";
+                break;
+            }
+
+            if ((polled[1].revents & POLLIN) != 0) {
+                char drained[64];
+                const ssize_t ignored = ::read(wake[0], drained, sizeof(drained));
+                static_cast<void>(ignored);
+            }
+            for (std::size_t i = 0; i < idle.size(); i++) {
+                if (polled[i + 2].revents == 0) {
+                    continue;
+                }
+                Connection& connection = *idle[i];
+                char buffer[4096];
+                const ssize_t n = ::read(connection.fd, buffer, sizeof(buffer));
+                if (n < 0) {
+                    connection.closed = errno != EINTR;
+                    continue;
+                }
+                if (n == 0) {
+                    connection.closed = true;
+                    continue;
+                }
+                connection.pending.append(buffer, static_cast<std::size_t>(n));
+                if (connection.pending.find('\n') == std::string::npos) {
+                    continue;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    connection.busy = true;
+                }
+                std::shared_ptr<Connection> busy = idle[i];
+                pool.submit([busy, &stats, &mutex, &wake] {
+                    answer_lines(*busy, stats);
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        busy->busy = false;
+                    }
+                    const char byte = 0;
+                    const ssize_t ignored = ::write(wake[1], &byte, 1);
+                    static_cast<void>(ignored);
+                });
+            }
+            if ((polled[0].revents & POLLIN) != 0) {
+                const int client = ::accept(listener, nullptr, nullptr);
+                if (client < 0) {
+                    if ((errno == EINTR) || (errno == ECONNABORTED)) {
+                        continue;
+                    }
+                    std::cerr << "Error: Unable to accept a connection: " << std::strerror(errno) << "\n";
+                    break;
+                }
+                auto connection = std::make_shared<Connection>();
+                connection->fd = client;
+                connection->handler = newSession();
+                std::lock_guard<std::mutex> lock(mutex);
+                connections.push_back(connection);
+            }
+        }
+    }
+    for (const std::shared_ptr<Connection>& connection : connections) {
+        ::close(connection->fd);
+    }
+    ::close(wake[0]);
+    ::close(wake[1]);
+    ::close(listener);
+    return EXIT_FAILURE;
+}
+
+} // namespace
+
+int serve_queries(const std::string& socketPath, const std::size_t numThreads, const SessionFactory& newSession)
+{
+    if (socketPath.empty()) {
+        return serve_stdio(newSession);
+    }
+    return serve_socket(socketPath, numThreads, newSession);
+}
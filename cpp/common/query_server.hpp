@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Answers one query given in command line syntax ("-exclude m,o -known 1s").
+// Results go to out, diagnostics to err; returns EXIT_SUCCESS or EXIT_FAILURE.
+using QueryHandler = std::function<int(const std::vector<std::string>& args, std::ostream& out, std::ostream& err)>;
+
+// Creates the handler for one connection, so a connection can keep state
+// (such as the candidates left in a game) from one request to the next.
+using SessionFactory = std::function<QueryHandler()>;
+
+// Serve queries with a dictionary that is already loaded.
+//
+// Protocol (one request per line, in both directions line-delimited):
+//   request:  the solver's usual arguments, e.g. "-exclude m,o -require u -known 1s,5e"
+//   response: "ok <n> <latency_us>" or "error <n> <latency_us>", followed by n lines
+//             (the matches, or the error messages)
+//   "stats" answers with request counts and latency figures, "quit" closes the connection.
+//
+// An empty socketPath serves a single client on stdin/stdout. Otherwise
+// clients connect to a Unix domain socket at socketPath. Any number can
+// stay connected: one thread polls them all, and the complete request
+// lines of a client are handed to one of numThreads workers, one batch
+// per client at a time so its requests stay in order. Returns once stdin
+// is exhausted; the socket server only returns on error.
+int serve_queries(const std::string& socketPath, std::size_t numThreads, const SessionFactory& newSession);
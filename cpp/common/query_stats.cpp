@@ -0,0 +1,66 @@
+#include "query_stats.hpp"
+
+#include <sys/resource.h>
+
+void add_load_stats(const LoadStats& load, const WordIndex& index, const std::size_t length, QueryStats& stats)
+{
+    stats.openMicros = load.openMicros;
+    stats.parseMicros = load.parseMicros;
+    stats.bytesRead = load.bytesRead;
+    stats.indexRebuilt = load.rebuilt;
+
+    const IndexHeader* header = index.header();
+    if (header == nullptr) {
+        return;
+    }
+    stats.sourceBytes = header->sourceSize;
+    stats.lines = header->numLines;
+    const bool indexed = (length >= MIN_WORD_LENGTH) && (length <= MAX_WORD_LENGTH);
+    stats.rejectedNonAlpha = indexed ? header->nonAlphaLines[length] : 0;
+    stats.scanned = index.words(length).count;
+    stats.rejectedLength = stats.lines - stats.rejectedNonAlpha - stats.scanned;
+}
+
+std::uint64_t peak_rss_bytes()
+{
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+void write_stats_json(const QueryStats& stats, std::ostream& out)
+{
+    const double totalMicros = stats.openMicros + stats.parseMicros + stats.compileMicros
+        + stats.scanMicros + stats.outputMicros;
+    out << "{\"timings_us\":{"
+        << "\"open\":" << stats.openMicros
+        << ",\"parse\":" << stats.parseMicros
+        << ",\"compile\":" << stats.compileMicros
+        << ",\"scan\":" << stats.scanMicros
+        << ",\"output\":" << stats.outputMicros
+        << ",\"total\":" << totalMicros
+        << "},\"input\":{"
+        << "\"bytes_read\":" << stats.bytesRead
+        << ",\"source_bytes\":" << stats.sourceBytes
+        << ",\"lines\":" << stats.lines
+        << ",\"index_rebuilt\":" << (stats.indexRebuilt ? "true" : "false")
+        << "},\"words\":{"
+        << "\"scanned\":" << stats.scanned
+        << ",\"matched\":" << stats.matched
+        << "},\"rejected\":{"
+        << "\"length\":" << stats.rejectedLength
+        << ",\"non_alpha\":" << stats.rejectedNonAlpha
+        << ",\"known\":" << stats.rejectedKnown
+        << ",\"excluded\":" << stats.rejectedExcluded
+        << ",\"required\":" << stats.rejectedRequired
+        << ",\"count\":" << stats.rejectedCount
+        << ",\"guess\":" << stats.rejectedGuess
+        << "},\"peak_rss_bytes\":" << peak_rss_bytes()
+        << "}\n";
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "word_index.hpp"
+
+// --stats: where the time of one query went and which predicate rejected
+// each line of the word list. Every line is counted once, by the first
+// predicate it fails, in this order:
+//   length    not of the query's length
+//   nonAlpha  of that length, but with a character other than a letter
+//   known     a -known letter is not in place
+//   excluded  contains an excluded letter
+//   required  lacks a required (-require/-include) letter
+//   count     has a letter too often or too rarely (-count/-anagram)
+//   guess     inconsistent with a -guess
+// so lines = sum of the rejections + matched.
+struct QueryStats {
+    // Wall time of each stage in microseconds.
+    double openMicros = 0;
+    double parseMicros = 0;
+    double compileMicros = 0;
+    double scanMicros = 0;
+    double outputMicros = 0;
+
+    std::uint64_t bytesRead = 0;
+    std::uint64_t sourceBytes = 0;
+    std::uint64_t lines = 0;
+    bool indexRebuilt = false;
+
+    std::uint64_t scanned = 0;
+    std::uint64_t matched = 0;
+
+    std::uint64_t rejectedLength = 0;
+    std::uint64_t rejectedNonAlpha = 0;
+    std::uint64_t rejectedKnown = 0;
+    std::uint64_t rejectedExcluded = 0;
+    std::uint64_t rejectedRequired = 0;
+    std::uint64_t rejectedCount = 0;
+    std::uint64_t rejectedGuess = 0;
+};
+
+// Fill in the load timings and the input counts for a query on words of
+// `length` letters. The length and nonAlpha rejections come from the
+// counts recorded in the index header.
+void add_load_stats(const LoadStats& load, const WordIndex& index, std::size_t length, QueryStats& stats);
+
+// Largest resident set size of the process so far, in bytes.
+std::uint64_t peak_rss_bytes();
+
+// The stats and the peak RSS as one line of JSON.
+void write_stats_json(const QueryStats& stats, std::ostream& out);
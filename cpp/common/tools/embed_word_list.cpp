@@ -0,0 +1,81 @@
+// Build step: write the index image of a word list as a C++ array, so the
+// solvers can start with their default dictionary already in .rodata.
+//
+//   embed_word_list <word list> <output.inc>
+//
+// An empty word list path writes an empty image; the solvers then read
+// BUNDLED_WORD_LIST at startup instead.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "word_index.hpp"
+
+namespace {
+
+constexpr std::size_t BYTES_PER_LINE = 24;
+
+// The index image of the word list. Its source mtime is left at 0, as the
+// embedded index is never checked against the file, so the output only
+// depends on the list's contents and builds are reproducible.
+bool build_embedded_image(const std::string& wordFilePath, std::vector<char>& image)
+{
+    std::ifstream file(wordFilePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error when trying to open \"" << wordFilePath << "\".\n";
+        return false;
+    }
+    const std::vector<char> text{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    image = build_index_image(text.data(), text.size(), text.size(), 0, 1);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <word list> <output.inc>\n";
+        return EXIT_FAILURE;
+    }
+    const std::string wordFilePath = argv[1];
+    const std::string outputPath = argv[2];
+
+    std::vector<char> image;
+    if ((wordFilePath != "") && !build_embedded_image(wordFilePath, image)) {
+        return EXIT_FAILURE;
+    }
+
+    // Written through a temporary file so that a failed run leaves no
+    // truncated header for make to consider up to date.
+    const std::string tmpPath = outputPath + ".tmp";
+    {
+        std::ofstream out(tmpPath);
+        out << "// Generated from \"" << wordFilePath << "\" by embed_word_list. Do not edit.\n";
+        out << "constexpr std::size_t EMBEDDED_INDEX_SIZE = " << image.size() << ";\n";
+        // Section offsets are 64-byte aligned within the image.
+        out << "alignas(64) constexpr unsigned char EMBEDDED_INDEX[" << (image.empty() ? 1 : image.size())
+            << "] = {";
+        for (std::size_t i = 0; i < image.size(); i++) {
+            out << ((i % BYTES_PER_LINE) == 0 ? "\n    " : " ") << static_cast<unsigned int>(
+                static_cast<unsigned char>(image[i])) << ",";
+        }
+        out << (image.empty() ? "0};\n" : "\n};\n");
+        if (!out) {
+            std::cerr << "Error: Unable to write \"" << tmpPath << "\".\n";
+            std::remove(tmpPath.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), outputPath.c_str()) != 0) {
+        std::cerr << "Error: Unable to write \"" << outputPath << "\".\n";
+        std::remove(tmpPath.c_str());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,442 @@
+#include "word_index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parallel.hpp"
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'W', 'R', 'D', 'L', 'I', 'D', 'X', '\0'};
+constexpr std::size_t SECTION_ALIGNMENT = 64;
+// Smallest part of a word list worth parsing on a thread of its own
+// (about 100k words).
+constexpr std::size_t MIN_PARSE_RANGE = 1 << 20;
+
+struct SourceInfo {
+    std::uint64_t size;
+    std::int64_t mtime;
+};
+
+bool stat_source(const std::string& path, SourceInfo& info)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    info.size = static_cast<std::uint64_t>(st.st_size);
+#ifdef __APPLE__
+    info.mtime = static_cast<std::int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    info.mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+std::size_t align_up(const std::size_t n)
+{
+    return (n + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// The words of part of a word list, grouped by length with each word's
+// letters back to back, and what was dropped.
+struct ParsedRange {
+    std::array<std::vector<char>, MAX_WORD_LENGTH + 1> records;
+    std::uint64_t numLines = 0;
+    std::array<std::uint64_t, MAX_WORD_LENGTH + 1> nonAlphaLines{};
+    std::uint32_t positionCounts[MAX_WORD_LENGTH + 1][MAX_WORD_LENGTH][26] = {};
+    std::uint32_t presenceCounts[MAX_WORD_LENGTH + 1][26] = {};
+};
+
+// Lowercase the lines of [line, end) and append the purely alphabetic words
+// of MIN_WORD_LENGTH..MAX_WORD_LENGTH letters to the range's records.
+void parse_words(const char* line, const char* const end, ParsedRange& range)
+{
+    std::array<std::vector<char>, MAX_WORD_LENGTH + 1>& records = range.records;
+    while (line < end) {
+        range.numLines++;
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* lineEnd = newline != nullptr ? newline : end;
+        const char* next = newline != nullptr ? newline + 1 : end;
+        if ((lineEnd > line) && (lineEnd[-1] == '\r')) {
+            lineEnd--;
+        }
+
+        const std::size_t length = lineEnd - line;
+        if ((length >= MIN_WORD_LENGTH) && (length <= MAX_WORD_LENGTH)) {
+            char word[MAX_WORD_LENGTH];
+            bool is_alpha_word = true;
+            for (std::size_t i = 0; i < length; i++) {
+                const char c = static_cast<char>(line[i] | 0x20);
+                if ((c < 'a') || (c > 'z')) {
+                    is_alpha_word = false;
+                    break;
+                }
+                word[i] = c;
+            }
+            if (is_alpha_word) {
+                records[length].insert(records[length].end(), word, word + length);
+                std::uint32_t present = 0;
+                for (std::size_t i = 0; i < length; i++) {
+                    range.positionCounts[length][i][word[i] - 'a']++;
+                    present |= 1u << (word[i] - 'a');
+                }
+                for (std::size_t c = 0; c < 26; c++) {
+                    range.presenceCounts[length][c] += (present >> c) & 1;
+                }
+            } else {
+                range.nonAlphaLines[length]++;
+            }
+        }
+        line = next;
+    }
+}
+
+double micros_since(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool build_image_from_file(const std::string& wordFilePath, const std::size_t numThreads, std::vector<char>& image,
+        LoadStats& stats, std::ostream& err)
+{
+    const auto openStart = std::chrono::steady_clock::now();
+    SourceInfo info;
+    void* text = nullptr;
+    std::size_t size = 0;
+    if (!stat_source(wordFilePath, info) || !map_file(wordFilePath, text, size)) {
+        err << "Error when trying to open \"" << wordFilePath << "\".\n";
+        return false;
+    }
+    stats.openMicros += micros_since(openStart);
+
+    const auto parseStart = std::chrono::steady_clock::now();
+    image = build_index_image(static_cast<const char*>(text), size, info.size, info.mtime, numThreads);
+    stats.parseMicros += micros_since(parseStart);
+    stats.bytesRead = size;
+    stats.rebuilt = true;
+    if (text != nullptr) {
+        ::munmap(text, size);
+    }
+    return true;
+}
+
+} // namespace
+
+bool map_file(const std::string& path, void*& data, std::size_t& size)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    data = nullptr;
+    if (size > 0) {
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = nullptr;
+            ::close(fd);
+            return false;
+        }
+    }
+    ::close(fd);
+    return true;
+}
+
+FILE* create_temp_file(const std::string& path, std::string& tmpPath)
+{
+    std::vector<char> name(path.begin(), path.end());
+    const char suffix[] = ".XXXXXX";
+    name.insert(name.end(), suffix, suffix + sizeof(suffix));
+    const int fd = ::mkstemp(name.data());
+    if (fd < 0) {
+        return nullptr;
+    }
+    tmpPath = name.data();
+    // mkstemp creates the file private to its owner; the caches are shared.
+    FILE* file = ::fdopen(fd, "wb");
+    if ((::fchmod(fd, 0644) != 0) || (file == nullptr)) {
+        if (file != nullptr) {
+            std::fclose(file);
+        } else {
+            ::close(fd);
+        }
+        std::remove(tmpPath.c_str());
+        return nullptr;
+    }
+    return file;
+}
+
+bool publish_temp_file(FILE* file, const std::string& tmpPath, const std::string& path, const bool written)
+{
+    if ((std::fclose(file) != 0) || !written || (std::rename(tmpPath.c_str(), path.c_str()) != 0)) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool write_file_atomically(const std::string& path, const std::vector<char>& image)
+{
+    std::string tmpPath;
+    FILE* file = create_temp_file(path, tmpPath);
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    return publish_temp_file(file, tmpPath, path, written);
+}
+
+WordIndex::~WordIndex()
+{
+    close();
+}
+
+bool WordIndex::open(const std::string& indexPath)
+{
+    close();
+    void* data = nullptr;
+    std::size_t size = 0;
+    if (!map_file(indexPath, data, size)) {
+        return false;
+    }
+    if (!validate(static_cast<const char*>(data), size)) {
+        if (data != nullptr) {
+            ::munmap(data, size);
+        }
+        return false;
+    }
+    mapping = data;
+    mappingSize = size;
+    image = static_cast<const char*>(data);
+    return true;
+}
+
+bool WordIndex::adopt(std::vector<char>&& newImage)
+{
+    close();
+    if (!validate(newImage.data(), newImage.size())) {
+        return false;
+    }
+    buffer = std::move(newImage);
+    image = buffer.data();
+    return true;
+}
+
+bool WordIndex::attach(const char* data, const std::size_t size)
+{
+    close();
+    if (!validate(data, size)) {
+        return false;
+    }
+    image = data;
+    return true;
+}
+
+void WordIndex::close()
+{
+    if (mapping != nullptr) {
+        ::munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    buffer.clear();
+    image = nullptr;
+}
+
+const IndexHeader* WordIndex::header() const
+{
+    return reinterpret_cast<const IndexHeader*>(image);
+}
+
+WordTable WordIndex::words(const std::size_t length) const
+{
+    WordTable table;
+    table.length = length;
+    if ((image == nullptr) || (length < MIN_WORD_LENGTH) || (length > MAX_WORD_LENGTH)) {
+        return table;
+    }
+    const IndexSection& section = header()->sections[length];
+    table.data = image + section.offset;
+    table.count = section.count;
+    return table;
+}
+
+LetterHistogram WordIndex::histogram(const std::size_t length) const
+{
+    LetterHistogram histogram;
+    if ((image == nullptr) || (length < MIN_WORD_LENGTH) || (length > MAX_WORD_LENGTH)) {
+        return histogram;
+    }
+    histogram.count = header()->sections[length].count;
+    histogram.positionCounts = header()->positionCounts[length];
+    histogram.presenceCounts = header()->presenceCounts[length];
+    return histogram;
+}
+
+bool WordIndex::validate(const char* data, const std::size_t size) const
+{
+    if ((data == nullptr) || (size < sizeof(IndexHeader))) {
+        return false;
+    }
+    const IndexHeader* h = reinterpret_cast<const IndexHeader*>(data);
+    if ((std::memcmp(h->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+            || (h->version != WORD_INDEX_VERSION)
+            || (h->headerSize != sizeof(IndexHeader))) {
+        return false;
+    }
+    for (std::size_t length = MIN_WORD_LENGTH; length <= MAX_WORD_LENGTH; length++) {
+        const IndexSection& section = h->sections[length];
+        if ((section.offset > size) || (section.count > (size - section.offset) / length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string get_index_path(const std::string& wordFilePath)
+{
+    return wordFilePath + ".idx";
+}
+
+std::vector<char> build_index_image(const char* text, const std::size_t size,
+        const std::uint64_t sourceSize, const std::int64_t sourceMtime, std::size_t numThreads)
+{
+    // Split the text into one newline-aligned range per thread; every line
+    // then lies entirely inside one range.
+    numThreads = std::max<std::size_t>(1, std::min(numThreads, size / MIN_PARSE_RANGE));
+    const char* const end = text + size;
+    std::vector<const char*> bounds(numThreads + 1, end);
+    bounds[0] = text;
+    for (std::size_t t = 1; t < numThreads; t++) {
+        const char* start = std::max(bounds[t - 1], text + ((size / numThreads) * t));
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - start));
+        bounds[t] = newline != nullptr ? newline + 1 : end;
+    }
+
+    std::vector<ParsedRange> ranges(numThreads);
+    parallel_for(numThreads, numThreads, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t t = first; t < last; t++) {
+            parse_words(bounds[t], bounds[t + 1], ranges[t]);
+        }
+    });
+
+    IndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = WORD_INDEX_VERSION;
+    header.headerSize = sizeof(IndexHeader);
+    header.sourceSize = sourceSize;
+    header.sourceMtime = sourceMtime;
+    for (const ParsedRange& range : ranges) {
+        header.numLines += range.numLines;
+        for (std::size_t length = MIN_WORD_LENGTH; length <= MAX_WORD_LENGTH; length++) {
+            header.nonAlphaLines[length] += range.nonAlphaLines[length];
+            for (std::size_t c = 0; c < 26; c++) {
+                for (std::size_t i = 0; i < length; i++) {
+                    header.positionCounts[length][i][c] += range.positionCounts[length][i][c];
+                }
+                header.presenceCounts[length][c] += range.presenceCounts[length][c];
+            }
+        }
+    }
+
+    std::size_t offset = align_up(sizeof(IndexHeader));
+    for (std::size_t length = MIN_WORD_LENGTH; length <= MAX_WORD_LENGTH; length++) {
+        std::size_t numBytes = 0;
+        for (const ParsedRange& range : ranges) {
+            numBytes += range.records[length].size();
+        }
+        header.sections[length].offset = offset;
+        header.sections[length].count = numBytes / length;
+        offset = align_up(offset + numBytes);
+    }
+
+    std::vector<char> image(offset, '\0');
+    std::memcpy(image.data(), &header, sizeof(header));
+    // Ranges are concatenated in file order, as a single pass would have.
+    for (std::size_t length = MIN_WORD_LENGTH; length <= MAX_WORD_LENGTH; length++) {
+        char* records = image.data() + header.sections[length].offset;
+        for (const ParsedRange& range : ranges) {
+            std::memcpy(records, range.records[length].data(), range.records[length].size());
+            records += range.records[length].size();
+        }
+    }
+    return image;
+}
+
+bool build_word_index(const std::string& wordFilePath, const std::string& indexPath, const std::size_t numThreads,
+        std::ostream& err)
+{
+    std::vector<char> image;
+    LoadStats stats;
+    if (!build_image_from_file(wordFilePath, numThreads, image, stats, err)) {
+        return false;
+    }
+    if (!write_file_atomically(indexPath, image)) {
+        err << "Error: Unable to write the index file \"" << indexPath << "\".\n";
+        return false;
+    }
+    return true;
+}
+
+bool load_word_list(const std::string& wordFilePath, WordIndex& index, const std::size_t numThreads,
+        std::ostream& err)
+{
+    LoadStats stats;
+    return load_word_list(wordFilePath, index, numThreads, stats, err);
+}
+
+bool load_word_list(const std::string& wordFilePath, WordIndex& index, const std::size_t numThreads,
+        LoadStats& stats, std::ostream& err)
+{
+    const std::string indexPath = get_index_path(wordFilePath);
+    stats = LoadStats();
+    const auto openStart = std::chrono::steady_clock::now();
+
+    SourceInfo info;
+    if (!stat_source(wordFilePath, info)) {
+        // No word list, but a prebuilt index may still have been shipped.
+        if (index.open(indexPath)) {
+            stats.openMicros = micros_since(openStart);
+            return true;
+        }
+        err << "Error when trying to open \"" << wordFilePath << "\".\n";
+        return false;
+    }
+
+    if (index.open(indexPath)) {
+        const IndexHeader* header = index.header();
+        if ((header->sourceSize == info.size) && (header->sourceMtime == info.mtime)) {
+            stats.openMicros = micros_since(openStart);
+            return true;
+        }
+        index.close();
+    }
+    stats.openMicros = micros_since(openStart);
+
+    std::vector<char> image;
+    if (!build_image_from_file(wordFilePath, numThreads, image, stats, err)) {
+        return false;
+    }
+    const auto writeStart = std::chrono::steady_clock::now();
+    const bool written = write_file_atomically(indexPath, image) && index.open(indexPath);
+    stats.parseMicros += micros_since(writeStart);
+    if (written) {
+        return true;
+    }
+    // Read-only location: use the index without persisting it.
+    return index.adopt(std::move(image));
+}
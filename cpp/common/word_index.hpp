@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr unsigned int MIN_WORD_LENGTH = 4;
+constexpr unsigned int MAX_WORD_LENGTH = 11;
+
+// Bump whenever the layout of IndexHeader or of the records changes.
+// Stale or foreign index files are then rebuilt instead of misread.
+constexpr std::uint32_t WORD_INDEX_VERSION = 3;
+
+// The word list used when no -list is given.
+constexpr const char* BUNDLED_WORD_LIST = "../../wordlewords.txt";
+
+// Location and size of the records for one word length.
+struct IndexSection {
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+// Fixed-size header at the start of every index file.
+// Records of length N are stored back to back (N bytes each, no separators)
+// starting at sections[N].offset, in the same order as the source file.
+struct IndexHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtime;
+    IndexSection sections[MAX_WORD_LENGTH + 1];
+    // Lines in the source, and those of each indexed length that were
+    // dropped for having a character other than a letter (for --stats).
+    std::uint64_t numLines;
+    std::uint64_t nonAlphaLines[MAX_WORD_LENGTH + 1];
+    // Letter frequencies of the words of each length: how many have letter
+    // c at position i, and how many contain it anywhere.
+    std::uint32_t positionCounts[MAX_WORD_LENGTH + 1][MAX_WORD_LENGTH][26];
+    std::uint32_t presenceCounts[MAX_WORD_LENGTH + 1][26];
+};
+
+// All words of one length, viewed in place.
+struct WordTable {
+    const char* data = nullptr;
+    std::size_t count = 0;
+    std::size_t length = 0;
+
+    std::string_view word(const std::size_t i) const
+    {
+        return std::string_view(data + (i * length), length);
+    }
+};
+
+// Letter frequencies of all words of one length, from the index header.
+struct LetterHistogram {
+    std::size_t count = 0;
+    const std::uint32_t (*positionCounts)[26] = nullptr;
+    const std::uint32_t* presenceCounts = nullptr;
+
+    // Fraction of the words with letter 'a' + c at position i.
+    double at_position(const std::size_t i, const std::size_t c) const
+    {
+        return count > 0 ? static_cast<double>(positionCounts[i][c]) / count : 0.0;
+    }
+
+    // Fraction of the words containing letter 'a' + c.
+    double containing(const std::size_t c) const
+    {
+        return count > 0 ? static_cast<double>(presenceCounts[c]) / count : 0.0;
+    }
+};
+
+// A validated index image: memory-mapped from disk, held in memory if the
+// index could not be written, or compiled into the binary.
+class WordIndex {
+public:
+    WordIndex() = default;
+    ~WordIndex();
+    WordIndex(const WordIndex&) = delete;
+    WordIndex& operator=(const WordIndex&) = delete;
+
+    bool open(const std::string& indexPath);
+    bool adopt(std::vector<char>&& image);
+    // Use an image that outlives the index (e.g. in .rodata) without a copy.
+    bool attach(const char* data, std::size_t size);
+    void close();
+
+    WordTable words(std::size_t length) const;
+    LetterHistogram histogram(std::size_t length) const;
+    const IndexHeader* header() const;
+
+private:
+    bool validate(const char* data, std::size_t size) const;
+
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    std::vector<char> buffer;
+    const char* image = nullptr;
+};
+
+// Map a whole file read-only. Empty files yield a null mapping.
+bool map_file(const std::string& path, void*& data, std::size_t& size);
+
+// Open a new temporary file next to path for writing, named path.XXXXXX
+// with a suffix unique to this call, so concurrent writers of the same
+// path never share one. Its name is stored in tmpPath. Null on error.
+FILE* create_temp_file(const std::string& path, std::string& tmpPath);
+
+// Close a file from create_temp_file and, if written, rename it over path,
+// so readers never see a partial file. False (and the temporary file
+// removed) on any error.
+bool publish_temp_file(FILE* file, const std::string& tmpPath, const std::string& path, bool written);
+
+// Write image to a temporary file and publish it over path.
+bool write_file_atomically(const std::string& path, const std::vector<char>& image);
+
+// "words.txt" -> "words.txt.idx"
+std::string get_index_path(const std::string& wordFilePath);
+
+// Parse a word list into an index image: lowercase, drop anything that is
+// not purely alphabetic or is outside MIN_WORD_LENGTH..MAX_WORD_LENGTH.
+// Large lists are split into newline-aligned ranges parsed on up to
+// numThreads threads; the image is the same for any thread count.
+std::vector<char> build_index_image(const char* text, std::size_t size,
+        std::uint64_t sourceSize, std::int64_t sourceMtime, std::size_t numThreads);
+
+// Build-index mode: write the index for wordFilePath to indexPath.
+bool build_word_index(const std::string& wordFilePath, const std::string& indexPath, std::size_t numThreads,
+        std::ostream& err);
+
+// How load_word_list got its index, for --stats.
+struct LoadStats {
+    // Checking, opening and mapping the word list and the index.
+    double openMicros = 0;
+    // Parsing the text and writing the index, if it had to be rebuilt.
+    double parseMicros = 0;
+    // Bytes of text parsed (0 if the index was current).
+    std::uint64_t bytesRead = 0;
+    bool rebuilt = false;
+    // The index is the one compiled into the binary, with no file behind it.
+    bool embedded = false;
+};
+
+// Open the index next to wordFilePath, (re)building it first if it is
+// missing, from an older format, or older than the word list.
+// Falls back to an in-memory index if the index file cannot be written.
+bool load_word_list(const std::string& wordFilePath, WordIndex& index, std::size_t numThreads, std::ostream& err);
+bool load_word_list(const std::string& wordFilePath, WordIndex& index, std::size_t numThreads, LoadStats& stats,
+        std::ostream& err);
+
+// Open the index of the bundled word list: the one compiled into the binary
+// (see embedded_word_list.cpp), so no file is read at all, or else the index
+// of BUNDLED_WORD_LIST relative to the working directory.
+bool load_bundled_word_list(WordIndex& index, std::size_t numThreads, LoadStats& stats, std::ostream& err);
@@ -0,0 +1,54 @@
+#include "benchmark.hpp"
+
+#include <sstream>
+
+#include "query.hpp"
+#include "thread_pool.hpp"
+#include "word_index.hpp"
+
+namespace regex_solver {
+
+bool bench_word_list(const std::string& wordFilePath, const std::string& listName,
+        const std::vector<BenchQuery>& corpus, std::vector<BenchResult>& results, std::ostream& err)
+{
+    // Also builds the word index on the first run, outside the timing.
+    Dictionary dictionary;
+    LoadStats loadStats;
+    if (!dictionary.load(wordFilePath, default_thread_count(), loadStats, err)) {
+        return false;
+    }
+    const std::size_t numWords = dictionary.word_index().words(5).count;
+
+    BenchResult load{listName, "load", "-", numWords, 0, 0};
+    load.nanos = time_per_call([&] {
+        WordIndex loaded;
+        load_word_list(wordFilePath, loaded, default_thread_count(), err);
+    }, load.iterations);
+    results.push_back(load);
+
+    for (const BenchQuery& benchQuery : corpus) {
+        Candidates candidates;
+        std::ostringstream messages;
+        if (!find_solutions(benchQuery.args, dictionary, wordFilePath, candidates, nullptr, messages, messages)) {
+            err << benchQuery.id << ": " << messages.str();
+            return false;
+        }
+
+        BenchResult filter{listName, "filter", benchQuery.id, numWords, 0, 0};
+        filter.nanos = time_per_call([&] {
+            find_solutions(benchQuery.args, dictionary, wordFilePath, candidates, nullptr, messages, messages);
+        }, filter.iterations);
+
+        BenchResult output{listName, "output", benchQuery.id, numWords, 0, 0};
+        output.nanos = time_per_call([&] {
+            std::ostringstream formatted;
+            print_solutions(candidates, formatted);
+        }, output.iterations);
+
+        results.push_back(filter);
+        results.push_back(output);
+    }
+    return true;
+}
+
+} // namespace regex_solver
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace regex_solver {
+
+// The regex solver's stages for run_benchmark: loading the word index, then
+// for each query of the corpus finding the solutions (argument parsing
+// included) and printing them.
+bool bench_word_list(const std::string& wordFilePath, const std::string& listName,
+        const std::vector<BenchQuery>& corpus, std::vector<BenchResult>& results, std::ostream& err);
+
+} // namespace regex_solver
@@ -0,0 +1,103 @@
+#include "position_matcher.hpp"
+
+#include <algorithm>
+
+namespace regex_solver {
+
+namespace {
+
+constexpr std::uint32_t ALL_LETTERS = (1u << 26) - 1;
+
+} // namespace
+
+PositionMatcher::PositionMatcher(const std::set<char>& excludedLetters, const std::vector<char>& knownPositions)
+    : allowed{},
+      wordLength(knownPositions.size())
+{
+    std::uint32_t unknownLetters = ALL_LETTERS;
+    for (const char c : excludedLetters) {
+        if ((c >= 'a') && (c <= 'z')) {
+            unknownLetters &= ~(1u << (c - 'a'));
+        }
+    }
+    for (std::size_t i = 0; i < wordLength; i++) {
+        const char c = knownPositions.at(i);
+        allowed[i] = c == '*' ? unknownLetters : 1u << (c - 'a');
+    }
+
+    // Left to right until order_checks knows better.
+    for (std::size_t i = 0; i < wordLength; i++) {
+        if (allowed[i] != ALL_LETTERS) {
+            checkPositions[numChecks] = static_cast<std::uint8_t>(i);
+            checkAllowed[numChecks] = allowed[i];
+            numChecks++;
+        }
+    }
+    numEarlyChecks = numChecks;
+}
+
+void PositionMatcher::require(const std::uint32_t requiredLetters)
+{
+    required = requiredLetters;
+}
+
+void PositionMatcher::order_checks(const LetterHistogram& histogram)
+{
+    if (histogram.count == 0) {
+        return;
+    }
+
+    std::array<double, MAX_WORD_LENGTH> rejection{};
+    for (std::size_t i = 0; i < wordLength; i++) {
+        double passing = 0;
+        for (std::size_t c = 0; c < 26; c++) {
+            passing += ((allowed[i] >> c) & 1) ? histogram.at_position(i, c) : 0.0;
+        }
+        rejection[i] = 1.0 - passing;
+    }
+
+    // Letters are treated as independent: P(all present) = prod P(c present).
+    // Bits above 'z' can never be present.
+    double allPresent = (required & ~ALL_LETTERS) != 0 ? 0.0 : 1.0;
+    for (std::size_t c = 0; c < 26; c++) {
+        allPresent *= ((required >> c) & 1) ? histogram.containing(c) : 1.0;
+    }
+    requiredRejection = 1.0 - allPresent;
+
+    std::array<std::uint8_t, MAX_WORD_LENGTH> positions = checkPositions;
+    std::stable_sort(positions.begin(), positions.begin() + numChecks,
+        [&rejection](const std::uint8_t a, const std::uint8_t b) { return rejection[a] > rejection[b]; });
+
+    // The required letter check goes before the first position check that
+    // rejects less per lookup than it does per letter of the word.
+    const double requiredPerLookup = requiredRejection / wordLength;
+    numEarlyChecks = numChecks;
+    for (std::size_t k = 0; k < numChecks; k++) {
+        checkPositions[k] = positions[k];
+        checkAllowed[k] = allowed[positions[k]];
+        checkRejection[k] = rejection[positions[k]];
+        if ((numEarlyChecks == numChecks) && (rejection[positions[k]] < requiredPerLookup)) {
+            numEarlyChecks = k;
+        }
+    }
+}
+
+void PositionMatcher::describe(std::ostream& out) const
+{
+    const auto describe_required = [this, &out] {
+        if (required != 0) {
+            out << "  required letters (" << (100.0 * requiredRejection) << "% rejected)\n";
+        }
+    };
+    for (std::size_t k = 0; k < numChecks; k++) {
+        if (k == numEarlyChecks) {
+            describe_required();
+        }
+        out << "  position " << (checkPositions[k] + 1) << " (" << (100.0 * checkRejection[k]) << "% rejected)\n";
+    }
+    if (numEarlyChecks == numChecks) {
+        describe_required();
+    }
+}
+
+} // namespace regex_solver
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <set>
+#include <vector>
+
+#include "word_index.hpp"
+
+namespace regex_solver {
+
+// The pattern the regex solver would build (e.g. ^s[^a-cmo]{3}e$),
+// compiled into one 26-bit mask of allowed letters per position, plus the
+// -include letters every match must contain.
+// Words must be lowercase and exactly length() letters long.
+//
+// A word is rejected as soon as one check fails, so the checks run in the
+// order that rejects words soonest for their cost (see order_checks).
+// Positions that allow every letter are not checked at all.
+class PositionMatcher {
+public:
+    PositionMatcher(const std::set<char>& excludedLetters, const std::vector<char>& knownPositions);
+
+    // Also require every letter of requiredLetters (bit c for 'a' + c).
+    void require(std::uint32_t requiredLetters);
+
+    // Order the checks by estimated rejection rate per unit of cost, from
+    // the letter frequencies of the words to be matched: a position check
+    // costs one lookup and rejects the words with a letter not allowed
+    // there; the required letter check costs a pass over the word and
+    // rejects the words missing any of the letters.
+    void order_checks(const LetterHistogram& histogram);
+
+    // The checks in order with their estimated rejection rates (--verbose).
+    void describe(std::ostream& out) const;
+
+    bool matches(const char* word) const
+    {
+        for (std::size_t k = 0; k < numEarlyChecks; k++) {
+            if (((checkAllowed[k] >> (word[checkPositions[k]] - 'a')) & 1) == 0) {
+                return false;
+            }
+        }
+        if (required != 0) {
+            std::uint32_t present = 0;
+            for (std::size_t i = 0; i < wordLength; i++) {
+                present |= 1u << (word[i] - 'a');
+            }
+            if ((present & required) != required) {
+                return false;
+            }
+        }
+        for (std::size_t k = numEarlyChecks; k < numChecks; k++) {
+            if (((checkAllowed[k] >> (word[checkPositions[k]] - 'a')) & 1) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::size_t length() const { return wordLength; }
+    std::uint32_t allowed_at(const std::size_t i) const { return allowed[i]; }
+    std::uint32_t required_letters() const { return required; }
+
+private:
+    std::array<std::uint32_t, MAX_WORD_LENGTH> allowed;
+    std::size_t wordLength;
+    std::uint32_t required = 0;
+
+    // The positions to check, in order, with their allowed letters; the
+    // required letters are checked after the first numEarlyChecks.
+    std::array<std::uint8_t, MAX_WORD_LENGTH> checkPositions;
+    std::array<std::uint32_t, MAX_WORD_LENGTH> checkAllowed;
+    std::size_t numChecks = 0;
+    std::size_t numEarlyChecks = 0;
+
+    // Estimated fraction of the words each check rejects, for describe().
+    std::array<double, MAX_WORD_LENGTH> checkRejection{};
+    double requiredRejection = 0;
+};
+
+} // namespace regex_solver
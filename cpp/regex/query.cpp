@@ -0,0 +1,587 @@
+#include "query.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <regex>
+#include <set>
+
+#include "args.hpp"
+#include "letter_rank.hpp"
+#include "parallel.hpp"
+#include "position_matcher.hpp"
+#include "query_stats.hpp"
+#include "thread_pool.hpp"
+
+namespace regex_solver {
+
+namespace {
+
+// Lists shorter than this per thread are matched on one thread, where
+// starting the others would cost more than the scan.
+constexpr std::size_t MIN_WORDS_PER_THREAD = 1 << 16;
+
+// --stats: split the words rejected by the letter masks into those with a
+// -known letter out of place and those with an excluded letter. Run only
+// when asked for, after the timed scan.
+void count_rejections(const WordTable& words, const std::set<char>& excludedLetters,
+        const std::vector<char>& knownPositions, QueryStats& stats)
+{
+    std::uint32_t excluded = 0;
+    for (const char c : excludedLetters) {
+        if ((c >= 'a') && (c <= 'z')) {
+            excluded |= 1u << (c - 'a');
+        }
+    }
+    for (std::size_t w = 0; w < words.count; w++) {
+        const char* word = words.data + (w * words.length);
+        bool knownMismatch = false;
+        bool hasExcluded = false;
+        for (std::size_t i = 0; i < words.length; i++) {
+            if (knownPositions[i] != '*') {
+                knownMismatch |= word[i] != knownPositions[i];
+            } else {
+                hasExcluded |= ((excluded >> (word[i] - 'a')) & 1) != 0;
+            }
+        }
+        stats.rejectedKnown += knownMismatch;
+        stats.rejectedExcluded += !knownMismatch && hasExcluded;
+    }
+}
+
+// The -include letters words of wordLength letters are filtered on: none
+// if there are more than the word has letters.
+std::set<char> get_included_letters(const std::string& includeArg, const std::size_t wordLength)
+{
+    std::set<char> includedLetters;
+    if ((wordLength < MIN_WORD_LENGTH) || includeArg.empty()) {
+        return includedLetters;
+    }
+    std::vector<std::string> includeArgs = split(includeArg, ',');
+    for (const std::string& arg : includeArgs) {
+        if (arg.length() != 1) {
+            continue;
+        }
+        const char c = arg.at(0);
+        if (std::isalpha(c)) {
+            includedLetters.insert(c);
+        }
+    }
+    if (includedLetters.size() > wordLength) {
+        includedLetters.clear();
+    }
+    return includedLetters;
+}
+
+} // namespace
+
+bool Dictionary::load(const std::string& wordFilePath, const std::size_t numThreads, LoadStats& stats,
+        std::ostream& err)
+{
+    const bool loaded = wordFilePath != "" ? load_word_list(wordFilePath, wordIndex, numThreads, stats, err)
+                                           : load_bundled_word_list(wordIndex, numThreads, stats, err);
+    listPath = stats.embedded ? "" : wordFilePath != "" ? wordFilePath : BUNDLED_WORD_LIST;
+    return loaded;
+}
+
+const WordDawg* Dictionary::word_dawg() const
+{
+    std::call_once(dawgOnce, [this] {
+        // The embedded index has no file to cache the graph next to.
+        dawgLoaded = listPath.empty() ? wordDawg.adopt(build_dawg_image(wordIndex), wordIndex)
+                                      : load_word_dawg(listPath, wordIndex, wordDawg);
+    });
+    return dawgLoaded ? &wordDawg : nullptr;
+}
+
+const LetterCounts* Dictionary::letter_counts(const std::size_t length) const
+{
+    std::call_once(letterCountsBuilt[length], [this, length] {
+        letterCounts[length] = count_letters(wordIndex.words(length), 1);
+    });
+    return letterCounts[length].data();
+}
+
+void filterWordsByLetterCounts(
+        Candidates& candidates,
+        const LetterCounts* counts,
+        const CountQuery& query)
+{
+    narrow_by_counts(counts, query, candidates.indices);
+}
+
+// Parse a -known entry such as "3u" (1-based position followed by a letter).
+bool parse_known_position(const std::string& arg, unsigned int& position, char& letter)
+{
+    std::size_t numDigits = 0;
+    while ((numDigits < arg.length()) && std::isdigit(static_cast<unsigned char>(arg.at(numDigits)))) {
+        numDigits++;
+    }
+    if ((numDigits == 0) || (numDigits > 2) || (arg.length() != numDigits + 1)) {
+        return false;
+    }
+    letter = arg.back();
+    if ((letter < 'a') || (letter > 'z')) {
+        return false;
+    }
+    position = std::stoul(arg.substr(0, numDigits));
+    return true;
+}
+
+bool compile_query(
+        const std::vector<std::string>& args,
+        const std::string& wordFilePathParam,
+        CompiledQuery& query,
+        std::ostream& out,
+        std::ostream& err)
+{
+    // Show how the user's arguments were interpreted.
+    const bool verbose = std::find(args.begin(), args.end(), "--verbose") != args.end();
+
+    // The length of the word to be found.
+    unsigned int tempWordLength = 5;
+    const std::string wordLengthParam = get_arg_param(args, "-length");
+    if (!wordLengthParam.empty()) {
+        try {
+            const unsigned int wordLengthParamValue = std::stoul(wordLengthParam);
+            tempWordLength = wordLengthParamValue;
+        } catch (const std::invalid_argument& ex) {
+            err << "Invalid parameter to -length argument: " << ex.what() << "\n";
+        } catch (const std::out_of_range& ex) {
+            err << "Parameter to -length argument was out of range: " << ex.what() << "\n";
+        }
+    }
+
+    // The whole word as a glob, one letter or '?' per position: -pattern s???e
+    // Sets the word length, and the letters are known positions.
+    const std::string patternArg = get_arg_param(args, "-pattern");
+    if (!patternArg.empty()) {
+        for (const char c : patternArg) {
+            if ((c != '?') && ((c < 'a') || (c > 'z'))) {
+                err << "Error: -pattern may only contain lowercase letters and '?'.\n";
+                return false;
+            }
+        }
+        if (!wordLengthParam.empty() && (tempWordLength != patternArg.length())) {
+            err << "Error: -pattern has " << patternArg.length() << " letters but -length is "
+                << tempWordLength << ".\n";
+            return false;
+        }
+        tempWordLength = static_cast<unsigned int>(patternArg.length());
+    }
+
+    // Rearrangements of some letters, '?' for any letter: -anagram crate or
+    // -anagram cra?e. Sets the word length too.
+    const std::string anagramArg = get_arg_param(args, "-anagram");
+    if (!anagramArg.empty()) {
+        if ((!wordLengthParam.empty() || !patternArg.empty()) && (tempWordLength != anagramArg.length())) {
+            err << "Error: -anagram has " << anagramArg.length() << " letters but the word has "
+                << tempWordLength << ".\n";
+            return false;
+        }
+        tempWordLength = static_cast<unsigned int>(anagramArg.length());
+    }
+    const unsigned int wordLength = tempWordLength;
+
+    // List of letters known to not be in the word.
+    // Separate multiple with a comma: -exclude m,s,e
+    const std::string excludeArg = get_arg_param(args, "-exclude");
+
+    // List of letters known to be in the word but whose positions are unknown.
+    // Separate multiple with a comma: -include m,s,e
+    const std::string includeArg = get_arg_param(args, "-include");
+
+    // List of known positions and letters.
+    // Separate multiple with a comma: -known 1m,2o,3u
+    const std::string knownArg = get_arg_param(args, "-known");
+
+    // How often letters occur, as bounds: -count e=2,a<=1,s>=1
+    const std::string countArg = get_arg_param(args, "-count");
+
+    // How to match each word: per-position letter masks (--engine=mask, the
+    // default), the same masks walking the word list's DAWG (--engine=dawg)
+    // or the equivalent std::regex (--engine=std), for comparison.
+    const std::string engineName = get_flag_value(args, "--engine");
+    if (!engineName.empty() && (engineName != "mask") && (engineName != "dawg") && (engineName != "std")) {
+        err << "Error: Unknown engine \"" << engineName << "\".\n";
+        return false;
+    }
+    const bool useStdRegex = engineName == "std";
+    const bool useDawg = engineName == "dawg";
+
+    // Order the matches by how common their letters are among the matches,
+    // best first: --rank, or --top K to keep only the best K.
+    const bool rank = std::find(args.begin(), args.end(), "--rank") != args.end();
+    const std::string topParam = get_arg_param(args, "--top");
+    std::size_t rankCount = rank ? SIZE_MAX : 0;
+    if (!topParam.empty()) {
+        rankCount = std::strtoul(topParam.c_str(), nullptr, 10);
+        if (rankCount == 0) {
+            err << "Error: --top must be a positive number.\n";
+            return false;
+        }
+    }
+
+    // Large word lists are split into ranges matched on this many threads.
+    const std::string threadsParam = get_arg_param(args, "-threads");
+    std::size_t numThreads = default_thread_count();
+    if (!threadsParam.empty()) {
+        numThreads = std::strtoul(threadsParam.c_str(), nullptr, 10);
+        if (numThreads == 0) {
+            err << "Error: -threads must be a positive number.\n";
+            return false;
+        }
+    }
+
+    // ------------------------
+    // VALIDATE USER ARGUMENTS
+    // ------------------------
+    if ((wordLength < MIN_WORD_LENGTH) || (wordLength > MAX_WORD_LENGTH)) {
+        err << "Error: Word length must be between " << MIN_WORD_LENGTH << " and " << MAX_WORD_LENGTH << ".\n";
+        return false;
+    }
+    if ((wordLength != 5) && (wordFilePathParam == "")) {
+        err << "Error: Must provide an alternate word list if using a word length other than 5.\n";	
+        return false;
+    }
+    if (excludeArg.empty() && includeArg.empty() && knownArg.empty() && patternArg.empty() && countArg.empty()
+            && anagramArg.empty() && (rankCount == 0)) {
+        err << "Error: No valid parameters were found for any of the options.\n";
+        return false;
+    }
+
+    // ------------------
+    // GET VALID LETTERS
+    // ------------------
+    // Use a set to prevent any letters from appearing more than once
+    std::set<char> excludedLetterSet;
+    std::vector<std::string> excludeArgs = split(excludeArg, ',');
+    for (const std::string& arg : excludeArgs) {
+        if (arg.length() != 1) {
+            continue;
+        }
+        const char c = arg.at(0);
+        if (std::isalpha(c)) {
+            excludedLetterSet.insert(c);
+        }
+    }
+
+    // Letters a -count or -anagram rules out are excluded like any other,
+    // so that the letter masks reject most words before their counts are
+    // looked at.
+    CountQuery countQuery;
+    std::string countError;
+    if ((!countArg.empty() && !parse_count_query(countArg, countQuery, countError))
+            || (!anagramArg.empty() && !parse_anagram(anagramArg, countQuery, countError))) {
+        err << "Error: " << countError << "\n";
+        return false;
+    }
+    for (std::size_t c = 0; c < 26; c++) {
+        if (((countQuery.excluded_letters() >> c) & 1) != 0) {
+            excludedLetterSet.insert(static_cast<char>('a' + c));
+        }
+    }
+
+    if (excludedLetterSet.size() >= 26) {
+        err << "Error: All letters of the alphabet have been excluded.\n";
+        return false;
+    }
+
+    // Now use the set to create a string of valid letters
+    std::string letterGroup = "[";
+    if (excludedLetterSet.empty()) {
+        letterGroup += "a-z";
+    } else {
+        letterGroup += '^';
+        char prev_letter = *(excludedLetterSet.begin());
+        const char last_letter = *(excludedLetterSet.rbegin());
+        unsigned int consec_letter_count = 0;
+        for (const char c : excludedLetterSet) {
+            if (c - prev_letter == 1) {
+                consec_letter_count++;
+                if (c == last_letter) {
+                    if (consec_letter_count > 1) {
+                        letterGroup += '-';
+                    }
+                    letterGroup += c;
+                }
+            } else {
+                if (consec_letter_count > 0) {
+                    if (consec_letter_count > 1) {
+                        letterGroup += '-';
+                    }
+                    letterGroup += prev_letter;
+                }
+                letterGroup += c;
+                consec_letter_count = 0;
+            }
+            prev_letter = c;
+        }
+    }
+    letterGroup += ']';
+
+    if (verbose) {
+        out << "Regex letter group for unknown positions:\n";
+        out << letterGroup << "\n\n";
+    }
+
+    // --------------------
+    // GET KNOWN POSITIONS
+    // --------------------
+    std::vector<std::string> knownArgs = split(knownArg, ',');
+    std::vector<char> knownPositions(wordLength, '*');
+    unsigned int numKnownPositions = 0;
+    for (std::size_t i = 0; i < patternArg.length(); i++) {
+        if (patternArg[i] != '?') {
+            knownPositions.at(i) = patternArg[i];
+            numKnownPositions++;
+        }
+    }
+    for (const std::string& arg : knownArgs) {
+        unsigned int position = 0;
+        char letter = '*';
+        if (parse_known_position(arg, position, letter)) {
+            if ((position < 1) || (position > wordLength)) {
+                continue;
+            }
+            knownPositions.at(position - 1) = letter;
+            numKnownPositions++;
+        }
+    }
+
+    // --------------------
+    // BUILD REGEX PATTERN
+    // --------------------
+    std::string regexString = "";
+    if (numKnownPositions == 0) {
+        regexString = letterGroup + "{" + std::to_string(wordLength) + "}";
+    } else {
+        unsigned int idx_last_unknown = 0;
+        unsigned int consec_unknown_count = 0;
+        const std::size_t end = knownPositions.size() - 1;
+        for (std::size_t i = 0; i < knownPositions.size(); i++) {
+            const char c = knownPositions.at(i);
+            const std::size_t prev_i = i - 1;
+            if (c == '*') {
+                idx_last_unknown = i;
+                consec_unknown_count++;
+                if (consec_unknown_count <= 1) {
+                    regexString += letterGroup;
+                } else if (i == end) {
+                    regexString += "{" + std::to_string(consec_unknown_count) + "}";
+                }
+            } else {
+                if ((idx_last_unknown == prev_i) && (consec_unknown_count > 1)) {
+                    regexString += "{" + std::to_string(consec_unknown_count) + "}";
+                }
+                regexString += c;
+                consec_unknown_count = 0;
+            }
+        }
+    }
+    regexString = "^" + regexString + "$";
+    if (verbose) {
+        out << "Regex pattern to apply to each word:\n";
+        out << regexString << "\n\n";
+    }
+
+    // The letter masks test the -include letters, and those a count
+    // requires, along with the positions.
+    query.matcher = PositionMatcher(excludedLetterSet, knownPositions);
+    query.requiredLetters = countQuery.required_letters();
+    for (const char c : get_included_letters(includeArg, wordLength)) {
+        // An uppercase letter matches no word: a bit above 'z' is never present.
+        query.requiredLetters |= ((c >= 'a') && (c <= 'z')) ? (1u << (c - 'a')) : (1u << 26);
+    }
+    query.matcher.require(query.requiredLetters);
+    query.wordLength = wordLength;
+    query.excludedLetters = excludedLetterSet;
+    query.knownPositions = knownPositions;
+    query.regexString = regexString;
+    query.counts = countQuery;
+    query.useStdRegex = useStdRegex;
+    query.useDawg = useDawg;
+    query.verbose = verbose;
+    query.rankCount = rankCount;
+    query.numThreads = numThreads;
+    return true;
+}
+
+bool find_solutions(
+        const std::vector<std::string>& args,
+        const Dictionary& dictionary,
+        const std::string& wordFilePathParam,
+        Candidates& candidates,
+        QueryStats* stats,
+        std::ostream& out,
+        std::ostream& err)
+{
+    const auto compileStart = std::chrono::steady_clock::now();
+    CompiledQuery query;
+    if (!compile_query(args, wordFilePathParam, query, out, err)) {
+        return false;
+    }
+    const unsigned int wordLength = query.wordLength;
+    const bool verbose = query.verbose;
+    const bool useStdRegex = query.useStdRegex;
+    const bool useDawg = query.useDawg;
+    const std::size_t numThreads = query.numThreads;
+    const std::uint32_t requiredLetters = query.requiredLetters;
+    const CountQuery& countQuery = query.counts;
+
+    // ---------------------------------
+    // APPLY ARGUMENTS TO WORDS IN FILE
+    // ---------------------------------
+    const WordIndex& wordIndex = dictionary.word_index();
+    const WordTable words = wordIndex.words(wordLength);
+    std::vector<std::uint32_t>& matches = candidates.indices;
+    candidates.words = words;
+    matches.resize(useDawg ? 0 : words.count);
+    const std::regex wordleRegex(useStdRegex ? query.regexString : std::string());
+    // With the checks most likely to reject a word first.
+    PositionMatcher& matcher = query.matcher;
+    matcher.order_checks(wordIndex.histogram(wordLength));
+    const WordDawg* dawg = useDawg ? dictionary.word_dawg() : nullptr;
+    if (useDawg && (dawg == nullptr)) {
+        err << "Error: Unable to build the DAWG of the word list.\n";
+        return false;
+    }
+    if (verbose && !useStdRegex && !useDawg) {
+        out << "Checks in order (estimated from the letter frequencies of the list):\n";
+        matcher.describe(out);
+        out << "\n";
+    }
+    const auto scanStart = std::chrono::steady_clock::now();
+    std::size_t numMatches = 0;
+    std::size_t numVisited = 0;
+    if (useDawg) {
+        // One walk of the graph, pruned at the first letter a prefix may
+        // not have; no word outside the surviving subtrees is looked at.
+        std::array<std::uint32_t, MAX_WORD_LENGTH> allowed;
+        for (std::size_t i = 0; i < wordLength; i++) {
+            allowed[i] = matcher.allowed_at(i);
+        }
+        numVisited = dawg->search(wordLength, allowed.data(), matcher.required_letters(), matches);
+        numMatches = matches.size();
+    } else if (useStdRegex) {
+        numMatches = parallel_filter(words.count, numThreads, MIN_WORDS_PER_THREAD, matches.data(),
+            [&](const std::size_t begin, const std::size_t end, std::uint32_t* out) {
+                std::size_t count = 0;
+                for (std::size_t i = begin; i < end; i++) {
+                    const char* word = words.data + (i * wordLength);
+                    out[count] = static_cast<std::uint32_t>(i - begin);
+                    count += std::regex_match(word, word + wordLength, wordleRegex);
+                }
+                return count;
+            });
+    } else {
+        numMatches = parallel_filter(words.count, numThreads, MIN_WORDS_PER_THREAD, matches.data(),
+            [&](const std::size_t begin, const std::size_t end, std::uint32_t* out) {
+                std::size_t count = 0;
+                for (std::size_t i = begin; i < end; i++) {
+                    out[count] = static_cast<std::uint32_t>(i - begin);
+                    count += matcher.matches(words.data + (i * wordLength));
+                }
+                return count;
+            });
+    }
+    matches.resize(numMatches);
+    const auto scanStop = std::chrono::steady_clock::now();
+    if (verbose) {
+        out << "Matched " << candidates.size() << " of " << words.count << " words in "
+            << std::chrono::duration<double, std::micro>(scanStop - scanStart).count() << " us ("
+            << (useStdRegex ? "std::regex" : useDawg ? "DAWG" : "letter masks");
+        if (useDawg) {
+            out << ", " << numVisited << " node visits in a graph of " << dawg->num_nodes(wordLength) << " nodes).\n\n";
+        } else {
+            out << ", " << numThreads << " threads).\n\n";
+        }
+    }
+
+    // std::regex tests no required letters: they are at least one of each.
+    if (useStdRegex && (requiredLetters != 0)) {
+        CountQuery required;
+        for (std::size_t c = 0; c < 26; c++) {
+            if (((requiredLetters >> c) & 1) != 0) {
+                required.bound(c, 1, MAX_LETTER_COUNT);
+            }
+        }
+        if ((requiredLetters >> 26) != 0) {
+            matches.clear();
+        }
+        filterWordsByLetterCounts(candidates, dictionary.letter_counts(wordLength), required);
+    }
+    const std::size_t numBeforeCounts = candidates.size();
+    if (countQuery.bounded()) {
+        filterWordsByLetterCounts(candidates, dictionary.letter_counts(wordLength), countQuery);
+        if (verbose) {
+            out << "After -count: " << candidates.size() << " words.\n\n";
+        }
+    }
+    candidates.numMatches = candidates.size();
+    candidates.scores.clear();
+    if (query.rankCount > 0) {
+        const std::vector<RankedWord> ranked = rank_by_letter_frequency(words, matches, query.rankCount);
+        matches.resize(ranked.size());
+        candidates.scores.resize(ranked.size());
+        for (std::size_t i = 0; i < ranked.size(); i++) {
+            matches[i] = ranked[i].index;
+            candidates.scores[i] = ranked[i].score;
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->compileMicros = std::chrono::duration<double, std::micro>(scanStart - compileStart).count();
+        stats->scanMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - scanStart).count();
+        count_rejections(words, query.excludedLetters, query.knownPositions, *stats);
+        stats->rejectedCount = numBeforeCounts - candidates.numMatches;
+        stats->rejectedRequired = words.count - stats->rejectedKnown - stats->rejectedExcluded - numBeforeCounts;
+        stats->matched = candidates.numMatches;
+    }
+    return true;
+}
+
+void print_solutions(const Candidates& candidates, std::ostream& out)
+{
+    if (candidates.empty()) {
+        out << "No solutions found.\n";
+        return;
+    }
+
+    if (candidates.scores.empty()) {
+        out << candidates.size() << " possible solutions:\n";
+        for (const std::uint32_t index : candidates.indices) {
+            out << candidates.words.word(index) << "\n";
+        }
+        return;
+    }
+
+    out << candidates.numMatches << " possible solutions, ";
+    if (candidates.size() < candidates.numMatches) {
+        out << "best " << candidates.size() << " ";
+    }
+    out << "by letter frequency:\n";
+    for (std::size_t i = 0; i < candidates.size(); i++) {
+        out << candidates[i] << " " << candidates.scores[i] << "\n";
+    }
+}
+
+int run_query(
+        const std::vector<std::string>& args,
+        const Dictionary& dictionary,
+        const std::string& wordFilePathParam,
+        std::ostream& out,
+        std::ostream& err)
+{
+    Candidates candidates;
+    if (!find_solutions(args, dictionary, wordFilePathParam, candidates, nullptr, out, err)) {
+        return EXIT_FAILURE;
+    }
+    print_solutions(candidates, out);
+    return EXIT_SUCCESS;
+}
+
+} // namespace regex_solver
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "letter_counts.hpp"
+#include "position_matcher.hpp"
+#include "query_stats.hpp"
+#include "word_dawg.hpp"
+#include "word_index.hpp"
+
+namespace regex_solver {
+
+// A word list's index, the DAWG of its words, opened (or built) the first
+// time a query uses --engine=dawg (only in memory for the embedded index),
+// and the letter counts of the words of each length, built the first time a
+// query on that length uses them.
+class Dictionary {
+public:
+    // "" loads the bundled word list.
+    bool load(const std::string& wordFilePath, std::size_t numThreads, LoadStats& stats, std::ostream& err);
+
+    const WordIndex& word_index() const { return wordIndex; }
+    // Null if the DAWG could not be built. Safe to call from several threads.
+    const WordDawg* word_dawg() const;
+    // Counts of the words of a length, in table order. Safe to call from
+    // several threads.
+    const LetterCounts* letter_counts(std::size_t length) const;
+
+private:
+    // Empty if the index is the embedded one.
+    std::string listPath;
+    WordIndex wordIndex;
+    mutable std::once_flag dawgOnce;
+    mutable WordDawg wordDawg;
+    mutable bool dawgLoaded = false;
+    mutable std::array<std::once_flag, MAX_WORD_LENGTH + 1> letterCountsBuilt;
+    mutable std::array<std::vector<LetterCounts>, MAX_WORD_LENGTH + 1> letterCounts;
+};
+
+// Words matching a query, as offsets into the word table they came from.
+// The table holds every word of one length back to back, so no word is
+// copied and filtering only moves indices.
+struct Candidates {
+    WordTable words;
+    std::vector<std::uint32_t> indices;
+    // With --rank or --top K the indices are best first (only the best K
+    // kept), scores[i] is the score of indices[i] and numMatches counts
+    // every match; otherwise scores is empty.
+    std::vector<std::uint32_t> scores;
+    std::size_t numMatches = 0;
+
+    std::size_t size() const { return indices.size(); }
+    bool empty() const { return indices.empty(); }
+    std::string_view operator[](const std::size_t i) const { return words.word(indices[i]); }
+};
+
+// Drop the candidates (indices into counts) outside the letter count
+// bounds of query, compacting the indices in place.
+void filterWordsByLetterCounts(
+        Candidates& candidates,
+        const LetterCounts* counts,
+        const CountQuery& query);
+
+// A query in command line syntax, parsed and checked.
+struct CompiledQuery {
+    unsigned int wordLength = 5;
+    std::set<char> excludedLetters;
+    // One letter per position, '*' where it is unknown.
+    std::vector<char> knownPositions;
+    // The equivalent regular expression, for --engine=std.
+    std::string regexString;
+    // Tests the positions and the required letters, checks in list order.
+    PositionMatcher matcher{std::set<char>(), std::vector<char>()};
+    // -include letters and those a count requires (bit 26 for a letter
+    // no word can contain).
+    std::uint32_t requiredLetters = 0;
+    CountQuery counts;
+    bool useStdRegex = false;
+    bool useDawg = false;
+    bool verbose = false;
+    std::size_t rankCount = 0;
+    std::size_t numThreads = 1;
+};
+
+// Parse the query options of args. wordFilePathParam is the -list given
+// ("" for the bundled list). --verbose output goes to out, errors to err.
+bool compile_query(
+        const std::vector<std::string>& args,
+        const std::string& wordFilePathParam,
+        CompiledQuery& query,
+        std::ostream& out,
+        std::ostream& err);
+
+// Parse a query in command line syntax and collect the matching words of
+// the dictionary into candidates. wordFilePathParam is the -list it was
+// loaded from ("" for the bundled list). Unless stats is null, the compile
+// and scan times and the rejections are added to it. --verbose output goes
+// to out, errors to err.
+bool find_solutions(
+        const std::vector<std::string>& args,
+        const Dictionary& dictionary,
+        const std::string& wordFilePathParam,
+        Candidates& candidates,
+        QueryStats* stats,
+        std::ostream& out,
+        std::ostream& err);
+
+void print_solutions(const Candidates& candidates, std::ostream& out);
+
+// find_solutions followed by print_solutions.
+int run_query(
+        const std::vector<std::string>& args,
+        const Dictionary& dictionary,
+        const std::string& wordFilePathParam,
+        std::ostream& out,
+        std::ostream& err);
+
+} // namespace regex_solver
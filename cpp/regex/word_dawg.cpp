@@ -0,0 +1,366 @@
+#include "word_dawg.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <sys/mman.h>
+
+namespace regex_solver {
+
+namespace {
+
+constexpr char DAWG_MAGIC[8] = {'W', 'R', 'D', 'L', 'D', 'W', 'G', '\0'};
+constexpr std::size_t SECTION_ALIGNMENT = 64;
+constexpr std::uint32_t LETTER_MASK = 31;
+constexpr std::uint32_t UNNUMBERED = UINT32_MAX;
+
+std::size_t align_up(const std::size_t n)
+{
+    return (n + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// The graph of one word length, before it is laid out in the image.
+struct GraphArrays {
+    std::vector<DawgNode> nodes;
+    std::vector<DawgEdge> edges;
+    std::vector<std::uint32_t> rankStarts;
+    std::vector<std::uint32_t> wordIndices;
+};
+
+// A node while the graph is built: (letter, child) edges in letter order.
+struct BuildNode {
+    std::vector<std::pair<std::uint8_t, std::uint32_t>> edges;
+};
+
+// Build the minimal graph of the words of one length incrementally, from
+// the words in alphabetical order (Daciuk et al.): once the next word
+// leaves the previous word's path, the nodes below the branching point can
+// no longer change, so each is replaced by an equal node seen before, or
+// registered as a new one.
+GraphArrays build_graph(const WordTable& words)
+{
+    GraphArrays graph;
+    graph.wordIndices.resize(words.count);
+    std::iota(graph.wordIndices.begin(), graph.wordIndices.end(), 0);
+    std::stable_sort(graph.wordIndices.begin(), graph.wordIndices.end(),
+        [&words](const std::uint32_t a, const std::uint32_t b) { return words.word(a) < words.word(b); });
+
+    const std::size_t length = words.length;
+    std::vector<BuildNode> nodes(1);
+    std::vector<std::uint32_t> freeNodes;
+    std::unordered_map<std::string, std::uint32_t> registry;
+    // The nodes on the previous word's path, by depth.
+    std::array<std::uint32_t, MAX_WORD_LENGTH + 1> path{};
+
+    const auto new_node = [&] {
+        if (!freeNodes.empty()) {
+            const std::uint32_t node = freeNodes.back();
+            freeNodes.pop_back();
+            return node;
+        }
+        nodes.emplace_back();
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    };
+    // Children are settled before their parents, so a node's edges (letters
+    // and settled child ids) identify its whole subtree.
+    const auto settle_below = [&](const std::size_t depth) {
+        for (std::size_t d = length; d > depth; d--) {
+            const std::uint32_t node = path[d];
+            std::string key;
+            for (const auto& [letter, child] : nodes[node].edges) {
+                key += static_cast<char>(letter);
+                key.append(reinterpret_cast<const char*>(&child), sizeof(child));
+            }
+            const auto [registered, inserted] = registry.emplace(std::move(key), node);
+            if (!inserted) {
+                nodes[path[d - 1]].edges.back().second = registered->second;
+                nodes[node].edges.clear();
+                freeNodes.push_back(node);
+            }
+        }
+    };
+
+    std::string_view previous;
+    for (std::size_t r = 0; r < graph.wordIndices.size(); r++) {
+        const std::string_view word = words.word(graph.wordIndices[r]);
+        if ((r > 0) && (word == previous)) {
+            continue;
+        }
+        std::size_t common = 0;
+        if (r > 0) {
+            while (word[common] == previous[common]) {
+                common++;
+            }
+            settle_below(common);
+        }
+        for (std::size_t d = common; d < length; d++) {
+            const std::uint32_t node = new_node();
+            nodes[path[d]].edges.emplace_back(static_cast<std::uint8_t>(word[d] - 'a'), node);
+            path[d + 1] = node;
+        }
+        graph.rankStarts.push_back(static_cast<std::uint32_t>(r));
+        previous = word;
+    }
+    if (!graph.wordIndices.empty()) {
+        settle_below(0);
+    }
+    graph.rankStarts.push_back(static_cast<std::uint32_t>(graph.wordIndices.size()));
+
+    // Number the nodes still reachable breadth first. Every path from a
+    // node to the end has the same length, so this is depth by depth, and
+    // in reverse every node comes after all of its children.
+    std::vector<std::uint32_t> number(nodes.size(), UNNUMBERED);
+    std::vector<std::uint32_t> order = {0};
+    number[0] = 0;
+    for (std::size_t i = 0; i < order.size(); i++) {
+        for (const auto& edge : nodes[order[i]].edges) {
+            if (number[edge.second] == UNNUMBERED) {
+                number[edge.second] = static_cast<std::uint32_t>(order.size());
+                order.push_back(edge.second);
+            }
+        }
+    }
+    // Distinct words below each node; the final node ends exactly one.
+    std::vector<std::uint32_t> wordsBelow(order.size(), 0);
+    for (std::size_t i = order.size(); i-- > 0;) {
+        const BuildNode& node = nodes[order[i]];
+        for (const auto& edge : node.edges) {
+            wordsBelow[i] += wordsBelow[number[edge.second]];
+        }
+        wordsBelow[i] += node.edges.empty() && !graph.wordIndices.empty();
+    }
+
+    graph.nodes.reserve(order.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        const BuildNode& node = nodes[order[i]];
+        graph.nodes.push_back({static_cast<std::uint32_t>(graph.edges.size()), static_cast<std::uint32_t>(node.edges.size())});
+        std::uint32_t rankBase = 0;
+        for (const auto& [letter, child] : node.edges) {
+            graph.edges.push_back({number[child], (rankBase << 5) | letter});
+            rankBase += wordsBelow[number[child]];
+        }
+    }
+    return graph;
+}
+
+template <typename T>
+void copy_section(std::vector<char>& image, const std::size_t offset, const std::vector<T>& values)
+{
+    if (!values.empty()) {
+        std::memcpy(image.data() + offset, values.data(), values.size() * sizeof(T));
+    }
+}
+
+} // namespace
+
+WordDawg::~WordDawg()
+{
+    close();
+}
+
+bool WordDawg::open(const std::string& dawgPath, const WordIndex& index)
+{
+    close();
+    void* data = nullptr;
+    std::size_t size = 0;
+    if (!map_file(dawgPath, data, size)) {
+        return false;
+    }
+    if (!validate(static_cast<const char*>(data), size, index)) {
+        if (data != nullptr) {
+            ::munmap(data, size);
+        }
+        return false;
+    }
+    mapping = data;
+    mappingSize = size;
+    image = static_cast<const char*>(data);
+    return true;
+}
+
+bool WordDawg::adopt(std::vector<char>&& newImage, const WordIndex& index)
+{
+    close();
+    if (!validate(newImage.data(), newImage.size(), index)) {
+        return false;
+    }
+    buffer = std::move(newImage);
+    image = buffer.data();
+    return true;
+}
+
+void WordDawg::close()
+{
+    if (mapping != nullptr) {
+        ::munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    buffer.clear();
+    image = nullptr;
+}
+
+std::size_t WordDawg::search(const std::size_t length, const std::uint32_t* allowed, const std::uint32_t required,
+        std::vector<std::uint32_t>& matches) const
+{
+    if ((image == nullptr) || (length < MIN_WORD_LENGTH) || (length > MAX_WORD_LENGTH)) {
+        return 0;
+    }
+    const DawgSection& section = reinterpret_cast<const DawgHeader*>(image)->sections[length];
+    const DawgNode* nodes = reinterpret_cast<const DawgNode*>(image + section.nodeOffset);
+    const DawgEdge* edges = reinterpret_cast<const DawgEdge*>(image + section.edgeOffset);
+    const std::uint32_t* rankStarts = reinterpret_cast<const std::uint32_t*>(image + section.rankOffset);
+    const std::uint32_t* wordIndices = reinterpret_cast<const std::uint32_t*>(image + section.wordOffset);
+
+    // Depth-first, one frame per letter of the prefix: the edges of the
+    // node still to follow, the rank of the first word below it and the
+    // letters of the prefix.
+    struct Frame {
+        std::uint32_t edge;
+        std::uint32_t end;
+        std::uint32_t rank;
+        std::uint32_t present;
+    };
+    std::array<Frame, MAX_WORD_LENGTH> stack;
+    stack[0] = {nodes[0].firstEdge, nodes[0].firstEdge + nodes[0].numEdges, 0, 0};
+    std::size_t depth = 0;
+    std::size_t numVisited = 1;
+    const std::size_t first = matches.size();
+    while (true) {
+        Frame& frame = stack[depth];
+        if (frame.edge == frame.end) {
+            if (depth == 0) {
+                break;
+            }
+            depth--;
+            continue;
+        }
+        const DawgEdge edge = edges[frame.edge++];
+        const std::uint32_t letter = edge.rankAndLetter & LETTER_MASK;
+        if (((allowed[depth] >> letter) & 1) == 0) {
+            continue;
+        }
+        const std::uint32_t present = frame.present | (1u << letter);
+        // Too few letters left to fit the required ones still missing.
+        const std::size_t missing = __builtin_popcount(required & ~present);
+        if (missing > length - depth - 1) {
+            continue;
+        }
+        const std::uint32_t rank = frame.rank + (edge.rankAndLetter >> 5);
+        numVisited++;
+        if (depth + 1 == length) {
+            matches.insert(matches.end(), wordIndices + rankStarts[rank], wordIndices + rankStarts[rank + 1]);
+            continue;
+        }
+        const DawgNode& node = nodes[edge.target];
+        depth++;
+        stack[depth] = {node.firstEdge, node.firstEdge + node.numEdges, rank, present};
+    }
+    // Alphabetical order back to word list order.
+    std::sort(matches.begin() + first, matches.end());
+    return numVisited;
+}
+
+std::size_t WordDawg::num_nodes(const std::size_t length) const
+{
+    if ((image == nullptr) || (length < MIN_WORD_LENGTH) || (length > MAX_WORD_LENGTH)) {
+        return 0;
+    }
+    return reinterpret_cast<const DawgHeader*>(image)->sections[length].numNodes;
+}
+
+bool WordDawg::validate(const char* data, const std::size_t size, const WordIndex& index) const
+{
+    const IndexHeader* source = index.header();
+    if ((data == nullptr) || (source == nullptr) || (size < sizeof(DawgHeader))) {
+        return false;
+    }
+    const DawgHeader* h = reinterpret_cast<const DawgHeader*>(data);
+    if ((std::memcmp(h->magic, DAWG_MAGIC, sizeof(DAWG_MAGIC)) != 0)
+            || (h->version != WORD_DAWG_VERSION)
+            || (h->headerSize != sizeof(DawgHeader))
+            || (h->sourceSize != source->sourceSize)
+            || (h->sourceMtime != source->sourceMtime)) {
+        return false;
+    }
+    const auto fits = [size](const std::uint64_t offset, const std::uint64_t count, const std::size_t entrySize) {
+        return (offset <= size) && (count <= (size - offset) / entrySize);
+    };
+    for (std::size_t length = MIN_WORD_LENGTH; length <= MAX_WORD_LENGTH; length++) {
+        const DawgSection& section = h->sections[length];
+        if ((section.numWords != index.words(length).count)
+                || (section.numNodes == 0)
+                || !fits(section.nodeOffset, section.numNodes, sizeof(DawgNode))
+                || !fits(section.edgeOffset, section.numEdges, sizeof(DawgEdge))
+                || !fits(section.rankOffset, section.numDistinct + 1, sizeof(std::uint32_t))
+                || !fits(section.wordOffset, section.numWords, sizeof(std::uint32_t))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string get_dawg_path(const std::string& wordFilePath)
+{
+    return wordFilePath + ".dawg";
+}
+
+std::vector<char> build_dawg_image(const WordIndex& index)
+{
+    std::array<GraphArrays, MAX_WORD_LENGTH + 1> graphs;
+    DawgHeader header{};
+    std::memcpy(header.magic, DAWG_MAGIC, sizeof(DAWG_MAGIC));
+    header.version = WORD_DAWG_VERSION;
+    header.headerSize = sizeof(DawgHeader);
+    header.sourceSize = index.header()->sourceSize;
+    header.sourceMtime = index.header()->sourceMtime;
+
+    std::size_t size = align_up(sizeof(DawgHeader));
+    for (std::size_t length = MIN_WORD_LENGTH; length <= MAX_WORD_LENGTH; length++) {
+        const GraphArrays& graph = graphs[length] = build_graph(index.words(length));
+        DawgSection& section = header.sections[length];
+        section.nodeOffset = size;
+        section.numNodes = graph.nodes.size();
+        size = align_up(size + (graph.nodes.size() * sizeof(DawgNode)));
+        section.edgeOffset = size;
+        section.numEdges = graph.edges.size();
+        size = align_up(size + (graph.edges.size() * sizeof(DawgEdge)));
+        section.rankOffset = size;
+        section.numDistinct = graph.rankStarts.size() - 1;
+        size = align_up(size + (graph.rankStarts.size() * sizeof(std::uint32_t)));
+        section.wordOffset = size;
+        section.numWords = graph.wordIndices.size();
+        size = align_up(size + (graph.wordIndices.size() * sizeof(std::uint32_t)));
+    }
+
+    std::vector<char> image(size, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    for (std::size_t length = MIN_WORD_LENGTH; length <= MAX_WORD_LENGTH; length++) {
+        const DawgSection& section = header.sections[length];
+        copy_section(image, section.nodeOffset, graphs[length].nodes);
+        copy_section(image, section.edgeOffset, graphs[length].edges);
+        copy_section(image, section.rankOffset, graphs[length].rankStarts);
+        copy_section(image, section.wordOffset, graphs[length].wordIndices);
+    }
+    return image;
+}
+
+bool load_word_dawg(const std::string& wordFilePath, const WordIndex& index, WordDawg& dawg)
+{
+    const std::string dawgPath = get_dawg_path(wordFilePath);
+    if (dawg.open(dawgPath, index)) {
+        return true;
+    }
+    std::vector<char> image = build_dawg_image(index);
+    if (write_file_atomically(dawgPath, image) && dawg.open(dawgPath, index)) {
+        return true;
+    }
+    // Read-only location: use the graph without persisting it.
+    return dawg.adopt(std::move(image), index);
+}
+
+} // namespace regex_solver
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "word_index.hpp"
+
+namespace regex_solver {
+
+// Bump whenever the layout of DawgHeader or of the sections changes.
+constexpr std::uint32_t WORD_DAWG_VERSION = 1;
+
+// The graph of the words of one length. Nodes, edges, rank starts and
+// word indices are each stored back to back at their offsets.
+struct DawgSection {
+    std::uint64_t nodeOffset;
+    std::uint64_t numNodes;
+    std::uint64_t edgeOffset;
+    std::uint64_t numEdges;
+    // numDistinct + 1 entries: the words spelled rank r are
+    // wordIndices[rankStarts[r]] .. wordIndices[rankStarts[r + 1] - 1].
+    std::uint64_t rankOffset;
+    std::uint64_t numDistinct;
+    std::uint64_t wordOffset;
+    std::uint64_t numWords;
+};
+
+// Fixed-size header at the start of every DAWG file. sourceSize and
+// sourceMtime are those of the index it was built from.
+struct DawgHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtime;
+    DawgSection sections[MAX_WORD_LENGTH + 1];
+};
+
+// Node 0 of each section is the root; the edges of a node are sorted by
+// letter. A node at depth N (the end of every word) has no edges.
+struct DawgNode {
+    std::uint32_t firstEdge;
+    std::uint32_t numEdges;
+};
+
+// The letter in the low 5 bits, and above them the number of distinct
+// words reached through the node's earlier edges: adding these up along a
+// path gives the alphabetical rank of the word it spells.
+struct DawgEdge {
+    std::uint32_t target;
+    std::uint32_t rankAndLetter;
+};
+
+// A directed acyclic word graph per word length: the trie of the distinct
+// words with every repeated subtree (mostly shared suffixes) stored once.
+// Memory-mapped from disk like the index, or held in memory.
+class WordDawg {
+public:
+    WordDawg() = default;
+    ~WordDawg();
+    WordDawg(const WordDawg&) = delete;
+    WordDawg& operator=(const WordDawg&) = delete;
+
+    // Both fail unless the graph was built from exactly this index.
+    bool open(const std::string& dawgPath, const WordIndex& index);
+    bool adopt(std::vector<char>&& image, const WordIndex& index);
+    void close();
+
+    // Walk the graph of words of `length` letters, following only the
+    // letters allowed[i] has at depth i, so a whole subtree is skipped as
+    // soon as its prefix is ruled out. Words must also contain every letter
+    // of required (bit c for 'a' + c). Appends the indices into
+    // index.words(length) of the matches, in word list order, to matches
+    // and returns how many nodes were visited (a node shared by several
+    // prefixes counts once for each).
+    std::size_t search(std::size_t length, const std::uint32_t* allowed, std::uint32_t required,
+            std::vector<std::uint32_t>& matches) const;
+
+    std::size_t num_nodes(std::size_t length) const;
+
+private:
+    bool validate(const char* data, std::size_t size, const WordIndex& index) const;
+
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    std::vector<char> buffer;
+    const char* image = nullptr;
+};
+
+// "words.txt" -> "words.txt.dawg"
+std::string get_dawg_path(const std::string& wordFilePath);
+
+// Build the graphs of every word length of the index.
+std::vector<char> build_dawg_image(const WordIndex& index);
+
+// Open the DAWG next to wordFilePath, (re)building it from the index if it
+// is missing or was built from another version of the list. Falls back to
+// an in-memory graph if the file cannot be written.
+bool load_word_dawg(const std::string& wordFilePath, const WordIndex& index, WordDawg& dawg);
+
+} // namespace regex_solver
@@ -0,0 +1,340 @@
+#include "word_stream.hpp"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <regex>
+#include <thread>
+#include <unistd.h>
+
+#include "query.hpp"
+
+namespace regex_solver {
+
+namespace {
+
+// Most a read fills at once. A pipe usually delivers less per read, and
+// the block is handed over as soon as it has anything, so matches from a
+// slow producer are not held back until a block is full.
+constexpr std::size_t STREAM_BLOCK_SIZE = 1 << 20;
+// Matches are written out in chunks of about this size.
+constexpr std::size_t OUTPUT_CHUNK_SIZE = 1 << 16;
+// Newlines are found 64 bytes at a time (see newline_mask).
+constexpr std::size_t SCAN_CHUNK_SIZE = 64;
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "newline_mask expects little-endian loads");
+
+struct Block {
+    // Padded so that the last chunk of a block can be loaded whole.
+    std::vector<char> data = std::vector<char>(STREAM_BLOCK_SIZE + SCAN_CHUNK_SIZE);
+    std::size_t size = 0;
+    // The stream ended (or failed) after this block's data.
+    bool last = false;
+    // Filled and not yet matched.
+    bool full = false;
+};
+
+// The two buffers, handed back and forth between the reader, which waits
+// for one to be empty, and the matcher, which waits for one to be full.
+class BlockExchange {
+public:
+    Block& wait_until(const std::size_t i, const bool full)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return blocks[i].full == full; });
+        return blocks[i];
+    }
+
+    void mark(const std::size_t i, const bool full)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            blocks[i].full = full;
+        }
+        changed.notify_all();
+    }
+
+private:
+    std::array<Block, 2> blocks;
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+// Reader thread: fill the blocks in turn until the end of the stream.
+// readError is set to errno if a read fails.
+void read_blocks(const int fd, BlockExchange& exchange, int& readError)
+{
+    for (std::size_t i = 0;; i ^= 1) {
+        Block& block = exchange.wait_until(i, false);
+        ssize_t n = 0;
+        do {
+            n = ::read(fd, block.data.data(), STREAM_BLOCK_SIZE);
+        } while ((n < 0) && (errno == EINTR));
+        if (n < 0) {
+            readError = errno;
+        }
+        block.size = n > 0 ? static_cast<std::size_t>(n) : 0;
+        block.last = n <= 0;
+        exchange.mark(i, true);
+        if (block.last) {
+            return;
+        }
+    }
+}
+
+// Bit k set where byte k of the 64 at p is a newline. Each 8 bytes are
+// compared at once (exactly, unlike the shorter has-zero-byte test, whose
+// borrows can flag the byte after a match), and a multiplication gathers
+// their 8 flags into one byte.
+std::uint64_t newline_mask(const char* p)
+{
+    constexpr std::uint64_t NEWLINES = 0x0a0a0a0a0a0a0a0a;
+    constexpr std::uint64_t LOW_SEVEN = 0x7f7f7f7f7f7f7f7f;
+    constexpr std::uint64_t GATHER = 0x0102040810204080;
+    std::uint64_t mask = 0;
+    for (std::size_t k = 0; k < SCAN_CHUNK_SIZE; k += 8) {
+        std::uint64_t v;
+        std::memcpy(&v, p + k, sizeof v);
+        v ^= NEWLINES;
+        const std::uint64_t flags = ~(((v & LOW_SEVEN) + LOW_SEVEN) | v | LOW_SEVEN) >> 7;
+        mask |= ((flags * GATHER) >> 56) << k;
+    }
+    return mask;
+}
+
+// Matches words against a compiled query, with the same normalization as
+// the word index: lowercased, and only purely alphabetic lines count.
+// Matches are buffered and written out in chunks.
+class WordMatcher {
+public:
+    WordMatcher(const CompiledQuery& query, std::ostream& out)
+        : query(query),
+          wordRegex(query.useStdRegex ? query.regexString : std::string()),
+          out(out)
+    {
+        pending.reserve(OUTPUT_CHUNK_SIZE + MAX_WORD_LENGTH + 1);
+    }
+
+    // A whole line, '\r' included, of any length.
+    void match_line(const char* line, std::size_t length)
+    {
+        if ((length > 0) && (line[length - 1] == '\r')) {
+            length--;
+        }
+        if (length == query.wordLength) {
+            match_word(line);
+        }
+    }
+
+    // A line known to have the query's length.
+    void match_word(const char* line)
+    {
+        const std::size_t length = query.wordLength;
+        std::array<char, MAX_WORD_LENGTH> word;
+        bool alphabetic = true;
+        for (std::size_t i = 0; i < length; i++) {
+            word[i] = static_cast<char>(line[i] | 0x20);
+            alphabetic &= (word[i] >= 'a') && (word[i] <= 'z');
+        }
+        if (!alphabetic) {
+            return;
+        }
+        numWords++;
+        if (!matches(word.data())) {
+            return;
+        }
+        numMatches++;
+        pending.append(word.data(), length);
+        pending += '\n';
+        if (pending.size() >= OUTPUT_CHUNK_SIZE) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!pending.empty()) {
+            out.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+            out.flush();
+            pending.clear();
+        }
+    }
+
+    std::size_t numWords = 0;
+    std::size_t numMatches = 0;
+
+private:
+    bool matches(const char* word) const
+    {
+        const std::size_t length = query.wordLength;
+        if (query.useStdRegex) {
+            std::uint32_t present = 0;
+            for (std::size_t i = 0; i < length; i++) {
+                present |= 1u << (word[i] - 'a');
+            }
+            if (((present & query.requiredLetters) != query.requiredLetters)
+                    || !std::regex_match(word, word + length, wordRegex)) {
+                return false;
+            }
+        } else if (!query.matcher.matches(word)) {
+            return false;
+        }
+        return !query.counts.bounded() || query.counts.matches(count_letters(word, length));
+    }
+
+    const CompiledQuery& query;
+    const std::regex wordRegex;
+    std::ostream& out;
+    std::string pending;
+};
+
+// Splits the stream into lines and passes those of the query's length to
+// a WordMatcher. A line of length L ends at a newline whose previous
+// newline is L + 1 bytes back (L + 2 with a '\r'), so shifting the newline
+// mask of a chunk finds those lines without visiting any other: in a list
+// of mixed lengths, stopping at every line would cost more than the scan.
+class LineSplitter {
+public:
+    explicit LineSplitter(WordMatcher& matcher, const std::size_t wordLength)
+        : matcher(matcher),
+          gap(wordLength + 1)
+    {
+    }
+
+    void add_block(const char* data, const std::size_t size)
+    {
+        // The first line completes the one carried over from the last block.
+        const char* firstNewline = static_cast<const char*>(std::memchr(data, '\n', size));
+        if (firstNewline == nullptr) {
+            add_to_carry(data, size);
+            return;
+        }
+        const std::size_t first = firstNewline - data;
+        add_to_carry(data, first);
+        finish_carry();
+
+        std::size_t lastNewline = first;
+        std::uint64_t previous = 0;
+        for (std::size_t base = first - (first % SCAN_CHUNK_SIZE); base < size; base += SCAN_CHUNK_SIZE) {
+            std::uint64_t newlines = newline_mask(data + base);
+            if (size - base < SCAN_CHUNK_SIZE) {
+                newlines &= (std::uint64_t{1} << (size - base)) - 1;
+            }
+            // Only newlines after the first end a line of this block.
+            const std::uint64_t lineEnds =
+                base <= first ? newlines & ~((std::uint64_t{2} << (first % SCAN_CHUNK_SIZE)) - 1) : newlines;
+            const std::uint64_t exact = (newlines << gap) | (previous >> (SCAN_CHUNK_SIZE - gap));
+            const std::uint64_t withReturn = (newlines << (gap + 1)) | (previous >> (SCAN_CHUNK_SIZE - gap - 1));
+            numLines += __builtin_popcountll(lineEnds);
+            for (std::uint64_t ends = lineEnds & (exact | withReturn); ends != 0; ends &= ends - 1) {
+                const std::size_t k = __builtin_ctzll(ends);
+                const std::size_t newline = base + k;
+                if (((exact >> k) & 1) != 0) {
+                    matcher.match_word(data + newline - (gap - 1));
+                } else if (data[newline - 1] == '\r') {
+                    matcher.match_word(data + newline - gap);
+                }
+            }
+            if (newlines != 0) {
+                lastNewline = base + (SCAN_CHUNK_SIZE - 1) - __builtin_clzll(newlines);
+            }
+            previous = newlines;
+        }
+        add_to_carry(data + lastNewline + 1, size - lastNewline - 1);
+    }
+
+    // End of the stream: a last line without a newline.
+    void finish()
+    {
+        if ((carryLength > 0) || carryTooLong) {
+            finish_carry();
+        }
+    }
+
+    std::size_t numLines = 0;
+
+private:
+    // Lines too long to be a word are only tracked until their end, so
+    // the carry stays bounded.
+    void add_to_carry(const char* p, const std::size_t length)
+    {
+        if (carryTooLong || (carryLength + length > carry.size())) {
+            carryTooLong = true;
+        } else {
+            std::memcpy(carry.data() + carryLength, p, length);
+            carryLength += length;
+        }
+    }
+
+    void finish_carry()
+    {
+        numLines++;
+        if (!carryTooLong) {
+            matcher.match_line(carry.data(), carryLength);
+        }
+        carryLength = 0;
+        carryTooLong = false;
+    }
+
+    WordMatcher& matcher;
+    const std::size_t gap;
+    std::array<char, MAX_WORD_LENGTH + 2> carry;
+    std::size_t carryLength = 0;
+    bool carryTooLong = false;
+};
+
+} // namespace
+
+int run_stream_query(const std::vector<std::string>& args, const int fd, std::ostream& out, std::ostream& err)
+{
+    CompiledQuery query;
+    if (!compile_query(args, "-", query, out, err)) {
+        return EXIT_FAILURE;
+    }
+    if (query.useDawg || (query.rankCount > 0)) {
+        err << "Error: --rank, --top and --engine=dawg need the whole word list and cannot be used with -list -.\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    BlockExchange exchange;
+    int readError = 0;
+    std::thread reader(read_blocks, fd, std::ref(exchange), std::ref(readError));
+
+    WordMatcher matcher(query, out);
+    LineSplitter splitter(matcher, query.wordLength);
+    std::size_t bytesRead = 0;
+    for (std::size_t i = 0;; i ^= 1) {
+        Block& block = exchange.wait_until(i, true);
+        bytesRead += block.size;
+        splitter.add_block(block.data.data(), block.size);
+        const bool last = block.last;
+        exchange.mark(i, false);
+        matcher.flush();
+        if (last) {
+            break;
+        }
+    }
+    reader.join();
+    splitter.finish();
+    matcher.flush();
+
+    if (readError != 0) {
+        err << "Error: Unable to read the word list: " << std::strerror(readError) << "\n";
+        return EXIT_FAILURE;
+    }
+    if (query.verbose) {
+        out << "\nMatched " << matcher.numMatches << " of " << matcher.numWords << " words (" << splitter.numLines
+            << " lines, " << bytesRead << " bytes) in "
+            << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+            << " ms.\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace regex_solver
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace regex_solver {
+
+// -list -: match the words of a stream (one per line, e.g. standard input)
+// as they arrive, printing each match without loading the list. A reader
+// thread fills two buffers in turn from fd while the calling thread matches
+// the words of the other one and writes out its matches, so memory stays
+// at two blocks however long the stream is.
+//
+// Options that need the whole list first (--rank, --top, --engine=dawg)
+// are rejected; the checks run in position order, as there are no letter
+// frequencies to order them by.
+int run_stream_query(const std::vector<std::string>& args, int fd, std::ostream& out, std::ostream& err);
+
+} // namespace regex_solver
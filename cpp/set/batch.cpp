@@ -0,0 +1,148 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace set_solver {
+
+namespace {
+
+// Words per tile: codes and letter masks of one tile fit in L1 cache.
+constexpr std::size_t TILE_WORDS = 2048;
+
+struct BatchQuery {
+    std::string id;
+    Query query;
+    KernelQuery filter;
+    std::string error;
+    std::size_t numMatches = 0;
+    std::vector<std::uint32_t> matches;
+};
+
+bool read_queries(const std::string& queriesPath, std::vector<BatchQuery>& queries, std::ostream& err)
+{
+    std::ifstream queryFile(queriesPath);
+    if (!queryFile.is_open()) {
+        err << "Error when trying to open \"" << queriesPath << "\".\n";
+        return false;
+    }
+
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(queryFile, line)) {
+        lineNumber++;
+        std::vector<std::string> args;
+        std::istringstream tokens(line);
+        std::string token;
+        while (tokens >> token) {
+            args.push_back(token);
+        }
+        if (args.empty() || (args.front().front() == '#')) {
+            continue;
+        }
+
+        BatchQuery batchQuery;
+        if (args.front().front() != '-') {
+            batchQuery.id = args.front();
+            args.erase(args.begin());
+        } else {
+            batchQuery.id = std::to_string(lineNumber);
+        }
+        std::ostringstream parseErrors;
+        if (!parse_query(args, batchQuery.query, parseErrors)) {
+            // Keep just the message: "Error: <message>\n" -> "<message>"
+            batchQuery.error = parseErrors.str();
+            batchQuery.error.erase(batchQuery.error.find_last_not_of('\n') + 1);
+            if (batchQuery.error.compare(0, 7, "Error: ") == 0) {
+                batchQuery.error.erase(0, 7);
+            }
+        } else if (batchQuery.query.length != WORDLE_WORD_LEN) {
+            batchQuery.error = "Batch mode only supports " + std::to_string(WORDLE_WORD_LEN) + "-letter words.";
+        } else if ((batchQuery.query.suggestCount > 0) || (batchQuery.query.rankCount > 0)
+                || (batchQuery.query.coverCount > 0)) {
+            // Batch output is the matches in list order.
+            batchQuery.error = "--suggest, --rank, --top and --cover are not supported in batch mode.";
+        } else if (!first_pass_filter(batchQuery.query, batchQuery.filter)) {
+            // Contradictory constraints: make the filter reject everything.
+            batchQuery.filter.excluded = ALL_LETTERS;
+            batchQuery.filter.required = ALL_LETTERS;
+        }
+        queries.push_back(std::move(batchQuery));
+    }
+    return true;
+}
+
+void run_queries(const PackedView& words, const LetterCounts* counts, std::vector<BatchQuery>& queries,
+        const std::size_t begin, const std::size_t end, const bool countOnly)
+{
+    std::vector<std::uint32_t> tileMatches(TILE_WORDS);
+    for (std::size_t first = 0; first < words.size(); first += TILE_WORDS) {
+        const PackedView tile = words.slice(first, std::min(TILE_WORDS, words.size() - first));
+        for (std::size_t q = begin; q < end; q++) {
+            BatchQuery& batchQuery = queries[q];
+            if (!batchQuery.error.empty()) {
+                continue;
+            }
+            const std::size_t numMatches = batchQuery.query.kernel.run(tile, batchQuery.filter, tileMatches.data());
+            const bool checkCounts = batchQuery.query.counts.bounded();
+            const bool checkGuesses = !batchQuery.query.guesses.empty();
+            for (std::size_t i = 0; i < numMatches; i++) {
+                const std::size_t w = first + tileMatches[i];
+                if ((checkCounts && !batchQuery.query.counts.matches(counts[w]))
+                        || (checkGuesses && !satisfies_guesses(batchQuery.query, tile.codes[tileMatches[i]]))) {
+                    continue;
+                }
+                batchQuery.numMatches++;
+                if (!countOnly) {
+                    batchQuery.matches.push_back(static_cast<std::uint32_t>(w));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int run_batch(const std::string& queriesPath, const Dictionary& dictionary,
+        const bool countOnly, const std::size_t numThreads, std::ostream& out, std::ostream& err)
+{
+    std::vector<BatchQuery> queries;
+    if (!read_queries(queriesPath, queries, err)) {
+        return EXIT_FAILURE;
+    }
+
+    const PackedView words = dictionary.packed();
+    // The letter counts are only built if a query has -count or -anagram.
+    const bool anyCounts = std::any_of(queries.begin(), queries.end(), [](const BatchQuery& batchQuery) {
+        return batchQuery.error.empty() && batchQuery.query.counts.bounded();
+    });
+    const LetterCounts* counts = anyCounts ? dictionary.letter_counts() : nullptr;
+    parallel_for(queries.size(), numThreads, [&](const std::size_t begin, const std::size_t end) {
+        run_queries(words, counts, queries, begin, end, countOnly);
+    });
+
+    const WordTable& table = dictionary.words();
+    for (const BatchQuery& batchQuery : queries) {
+        if (!batchQuery.error.empty()) {
+            out << (countOnly ? "" : "# ") << batchQuery.id << " error: " << batchQuery.error << "\n";
+            continue;
+        }
+        if (countOnly) {
+            out << batchQuery.id << " " << batchQuery.numMatches << "\n";
+            continue;
+        }
+        out << "# " << batchQuery.id << " " << batchQuery.numMatches << "\n";
+        for (const std::uint32_t w : batchQuery.matches) {
+            out << table.word(w) << "\n";
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace set_solver
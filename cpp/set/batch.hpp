@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#include "query.hpp"
+
+namespace set_solver {
+
+// Batch mode: run every query in queriesPath (one per line, in the usual
+// argument syntax, optionally preceded by an ID) against the dictionary.
+// Lines with --suggest, --rank, --top or --cover are reported as errors.
+//
+// Queries are split across numThreads threads; each thread walks the packed
+// words once, tile by tile, and runs all of its queries on a tile while it
+// is still in cache. Results are written in input order, either as blocks
+//   # <id> <count>
+//   <matches...>
+// or, with countOnly, as one "<id> <count>" line per query.
+int run_batch(const std::string& queriesPath, const Dictionary& dictionary,
+        bool countOnly, std::size_t numThreads, std::ostream& out, std::ostream& err);
+
+} // namespace set_solver
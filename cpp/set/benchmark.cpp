@@ -0,0 +1,58 @@
+#include "benchmark.hpp"
+
+#include <sstream>
+
+#include "query.hpp"
+#include "thread_pool.hpp"
+
+namespace set_solver {
+
+bool bench_word_list(const std::string& wordFilePath, const std::string& listName,
+        const std::vector<BenchQuery>& corpus, std::vector<BenchResult>& results, std::ostream& err)
+{
+    // Also builds the word index on the first run, outside the timing.
+    Dictionary dictionary;
+    if (!dictionary.load(wordFilePath, default_thread_count(), err)) {
+        return false;
+    }
+    const std::size_t numWords = dictionary.packed().size();
+
+    BenchResult load{listName, "load", "-", numWords, 0, 0};
+    load.nanos = time_per_call([&] {
+        Dictionary loaded;
+        loaded.load(wordFilePath, default_thread_count(), err);
+    }, load.iterations);
+    results.push_back(load);
+
+    for (const BenchQuery& benchQuery : corpus) {
+        Query query;
+        std::ostringstream errors;
+        if (!parse_query(benchQuery.args, query, errors)) {
+            err << benchQuery.id << ": " << errors.str();
+            return false;
+        }
+
+        BenchResult parse{listName, "query_parse", benchQuery.id, numWords, 0, 0};
+        parse.nanos = time_per_call([&] {
+            Query parsed;
+            parse_query(benchQuery.args, parsed, errors);
+        }, parse.iterations);
+
+        std::vector<std::uint32_t> matches;
+        BenchResult filter{listName, "filter", benchQuery.id, numWords, 0, 0};
+        filter.nanos = time_per_call([&] { matches = find_matches(dictionary, query, nullptr, errors); }, filter.iterations);
+
+        BenchResult output{listName, "output", benchQuery.id, numWords, 0, 0};
+        output.nanos = time_per_call([&] {
+            std::ostringstream formatted;
+            print_results(dictionary, query, matches, formatted, errors);
+        }, output.iterations);
+
+        results.push_back(parse);
+        results.push_back(filter);
+        results.push_back(output);
+    }
+    return true;
+}
+
+} // namespace set_solver
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace set_solver {
+
+// The set solver's stages for run_benchmark: loading the dictionary, then
+// for each query of the corpus parsing it, finding the matches and
+// formatting them.
+bool bench_word_list(const std::string& wordFilePath, const std::string& listName,
+        const std::vector<BenchQuery>& corpus, std::vector<BenchResult>& results, std::ostream& err);
+
+} // namespace set_solver
@@ -0,0 +1,181 @@
+#include "constraints.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace set_solver {
+
+Constraints::Constraints()
+{
+    allowed.fill(ALL_LETTERS);
+    minCount.fill(0);
+    maxCount.fill(WORDLE_WORD_LEN);
+}
+
+bool Constraints::add_guess(std::string_view guess, std::string_view feedback, std::string& error)
+{
+    if ((guess.length() != WORDLE_WORD_LEN) || (feedback.length() != WORDLE_WORD_LEN)) {
+        error = "Guesses and their feedback must both be " + std::to_string(WORDLE_WORD_LEN) + " letters long.";
+        return false;
+    }
+
+    std::array<char, WORDLE_WORD_LEN> letters;
+    std::array<char, WORDLE_WORD_LEN> colors;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        letters[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(guess[i])));
+        colors[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(feedback[i])));
+        if ((letters[i] < 'a') || (letters[i] > 'z')) {
+            error = "The guess \"" + std::string(guess) + "\" is not a word.";
+            return false;
+        }
+        if ((colors[i] != 'g') && (colors[i] != 'y') && (colors[i] != 'b')) {
+            error = "Feedback must consist of g (green), y (yellow) and b (black) only.";
+            return false;
+        }
+    }
+
+    // Count the occurrences of each letter the feedback confirms, and note
+    // which letters were also marked absent (so that count is exact).
+    std::array<std::uint8_t, 26> confirmed{};
+    std::uint32_t capped = 0;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        const std::size_t letter = letters[i] - 'a';
+        if (colors[i] == 'g') {
+            allowed[i] &= 1u << letter;
+            confirmed[letter]++;
+        } else {
+            allowed[i] &= ~(1u << letter);
+            if (colors[i] == 'y') {
+                confirmed[letter]++;
+            } else {
+                capped |= 1u << letter;
+            }
+        }
+    }
+
+    for (std::size_t letter = 0; letter < 26; letter++) {
+        minCount[letter] = std::max(minCount[letter], confirmed[letter]);
+        if ((capped >> letter) & 1) {
+            maxCount[letter] = std::min(maxCount[letter], confirmed[letter]);
+        }
+        if (maxCount[letter] == 0) {
+            exclude_letters(1u << letter);
+        }
+    }
+
+    if (contradictory()) {
+        error = "The feedback for \"" + std::string(guess) + "\" contradicts the earlier constraints.";
+        return false;
+    }
+    return true;
+}
+
+void Constraints::add_known(const std::size_t position, const char letter)
+{
+    allowed[position] &= 1u << (letter - 'a');
+}
+
+void Constraints::exclude_letters(const std::uint32_t letters)
+{
+    for (std::uint32_t& positionLetters : allowed) {
+        positionLetters &= ~letters;
+    }
+    for (std::size_t letter = 0; letter < 26; letter++) {
+        if ((letters >> letter) & 1) {
+            maxCount[letter] = 0;
+        }
+    }
+}
+
+void Constraints::require_letters(const std::uint32_t letters)
+{
+    for (std::size_t letter = 0; letter < 26; letter++) {
+        if (((letters >> letter) & 1) && (minCount[letter] == 0)) {
+            minCount[letter] = 1;
+        }
+    }
+}
+
+bool Constraints::contradictory() const
+{
+    std::size_t totalMin = 0;
+    for (std::size_t letter = 0; letter < 26; letter++) {
+        if (minCount[letter] > maxCount[letter]) {
+            return true;
+        }
+        totalMin += minCount[letter];
+    }
+    return (totalMin > WORDLE_WORD_LEN)
+        || std::any_of(allowed.begin(), allowed.end(), [](const std::uint32_t letters) { return letters == 0; });
+}
+
+KernelQuery Constraints::prefilter() const
+{
+    KernelQuery query;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        // Exactly one letter allowed: the position is known.
+        if ((allowed[i] != 0) && ((allowed[i] & (allowed[i] - 1)) == 0)) {
+            query.knownMask |= LETTER_MASK << (LETTER_BITS * i);
+            query.knownValue |= static_cast<std::uint32_t>(__builtin_ctz(allowed[i])) << (LETTER_BITS * i);
+        }
+    }
+    for (std::size_t letter = 0; letter < 26; letter++) {
+        if (maxCount[letter] == 0) {
+            query.excluded |= 1u << letter;
+        }
+        if (minCount[letter] > 0) {
+            query.required |= 1u << letter;
+        }
+    }
+    return query;
+}
+
+bool Constraints::matches(const std::uint32_t code) const
+{
+    std::array<std::uint8_t, 26> counts{};
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        const std::uint32_t letter = letter_at(code, i);
+        if (((allowed[i] >> letter) & 1) == 0) {
+            return false;
+        }
+        counts[letter]++;
+    }
+    for (std::size_t letter = 0; letter < 26; letter++) {
+        if ((counts[letter] < minCount[letter]) || (counts[letter] > maxCount[letter])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool split_guess_param(const std::string& param, std::string& guess, std::string& feedback)
+{
+    const std::size_t colon = param.find(':');
+    if ((colon == std::string::npos) || (param.find(':', colon + 1) != std::string::npos)) {
+        return false;
+    }
+    guess = param.substr(0, colon);
+    feedback = param.substr(colon + 1);
+    return true;
+}
+
+void narrow_candidates(const PackedView& words, const Constraints& constraints, std::vector<std::uint32_t>& candidates)
+{
+    const auto rejected = [&](const std::uint32_t w) { return !constraints.matches(words.codes[w]); };
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), rejected), candidates.end());
+}
+
+bool combine_queries(KernelQuery& query, const KernelQuery& other)
+{
+    const std::uint32_t sharedPositions = query.knownMask & other.knownMask;
+    if (((query.knownValue ^ other.knownValue) & sharedPositions) != 0) {
+        return false;
+    }
+    query.knownMask |= other.knownMask;
+    query.knownValue |= other.knownValue;
+    query.excluded |= other.excluded;
+    query.required |= other.required;
+    return true;
+}
+
+} // namespace set_solver
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "filter_kernel.hpp"
+#include "packed_words.hpp"
+
+namespace set_solver {
+
+constexpr std::uint32_t ALL_LETTERS = (1u << 26) - 1;
+
+// Everything that is known about the hidden word: the letters still
+// possible at each position and how often each letter may occur.
+// Unlike -exclude/-require/-known this can express "present, but not at
+// position 3" and repeated letters ("exactly one e").
+struct Constraints {
+    std::array<std::uint32_t, WORDLE_WORD_LEN> allowed;
+    std::array<std::uint8_t, 26> minCount;
+    std::array<std::uint8_t, 26> maxCount;
+
+    Constraints();
+
+    // Fold in the feedback for one guess, e.g. ("crane", "gybbg") with
+    // g = right letter and position, y = elsewhere in the word, b = absent
+    // (or, for a repeated letter, no further occurrences).
+    bool add_guess(std::string_view guess, std::string_view feedback, std::string& error);
+
+    void add_known(std::size_t position, char letter);
+    void exclude_letters(std::uint32_t letters);
+    void require_letters(std::uint32_t letters);
+
+    // True if no word can satisfy these constraints.
+    bool contradictory() const;
+
+    // The part of the constraints a filter kernel can test: fixed letters,
+    // letters known to be absent and letters known to be present.
+    KernelQuery prefilter() const;
+
+    // Full check of one packed word.
+    bool matches(std::uint32_t code) const;
+};
+
+// Parse "crane:gybbg" into its guess and feedback.
+bool split_guess_param(const std::string& param, std::string& guess, std::string& feedback);
+
+// Keep only the candidates (indices into words) that satisfy constraints.
+void narrow_candidates(const PackedView& words, const Constraints& constraints, std::vector<std::uint32_t>& candidates);
+
+// Combine two kernel queries into one that matches their intersection.
+// Returns false if they cannot both hold (two letters fixed at one position).
+bool combine_queries(KernelQuery& query, const KernelQuery& other);
+
+} // namespace set_solver
@@ -0,0 +1,220 @@
+#include "cover.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+#include "constraints.hpp"
+#include "parallel.hpp"
+
+namespace set_solver {
+
+namespace {
+
+// The top of the search tree is cut into at least this many tasks per
+// thread: the subtrees differ in size by orders of magnitude.
+constexpr std::size_t TASKS_PER_THREAD = 64;
+
+// A node of the search tree, for handing subtrees to other threads.
+struct SearchState {
+    std::uint32_t covered = 0;
+    // Letters left uncovered: no word chosen below may contain them.
+    std::uint32_t skipped = 0;
+    // Position in the rarity order of the next letter to settle.
+    std::size_t next = 0;
+    // Indices into the distinct letter sets.
+    std::vector<std::uint32_t> chosen;
+};
+
+// One search for a cover of at least `target` letters.
+struct SearchRun {
+    std::size_t target = 0;
+    // How many letters may be left uncovered.
+    std::size_t maxSkipped = 0;
+    // While splitting: the nodes after splitLevel decisions (a word chosen
+    // or a letter skipped) are collected here instead of being searched.
+    std::vector<SearchState>* tasks = nullptr;
+    std::size_t splitLevel = 0;
+    // While searching task taskIndex: the first task known to have a
+    // cover, after which the later ones give up.
+    const std::atomic<std::size_t>* firstFound = nullptr;
+    std::size_t taskIndex = 0;
+};
+
+class CoverSearch {
+public:
+    CoverSearch(const PackedView& words, const std::uint32_t testedLetters, const std::size_t count)
+        : count(count)
+    {
+        // Words with the same untested letters are interchangeable: keep the first.
+        std::unordered_map<std::uint32_t, std::uint32_t> seen;
+        for (std::size_t w = 0; w < words.size(); w++) {
+            const std::uint32_t letters = words.letters[w] & ~testedLetters & ALL_LETTERS;
+            if ((letters != 0) && seen.emplace(letters, static_cast<std::uint32_t>(w)).second) {
+                letterSets.push_back(letters);
+                firstWords.push_back(static_cast<std::uint32_t>(w));
+                coverableLetters |= letters;
+                maxLetters = std::max<std::size_t>(maxLetters, __builtin_popcount(letters));
+            }
+        }
+
+        std::array<std::size_t, 26> frequency{};
+        for (const std::uint32_t letters : letterSets) {
+            for (std::size_t c = 0; c < 26; c++) {
+                frequency[c] += (letters >> c) & 1;
+            }
+        }
+        for (std::size_t c = 0; c < 26; c++) {
+            if (((coverableLetters >> c) & 1) != 0) {
+                order.push_back(c);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&frequency](const std::size_t a, const std::size_t b) { return frequency[a] < frequency[b]; });
+
+        // The sets with the most letters first, as they reach the target soonest.
+        buckets.resize(order.size());
+        for (std::size_t r = 0; r < order.size(); r++) {
+            for (std::uint32_t set = 0; set < letterSets.size(); set++) {
+                if (((letterSets[set] >> order[r]) & 1) != 0) {
+                    buckets[r].push_back(set);
+                }
+            }
+            std::stable_sort(buckets[r].begin(), buckets[r].end(), [this](const std::uint32_t a, const std::uint32_t b) {
+                return __builtin_popcount(letterSets[a]) > __builtin_popcount(letterSets[b]);
+            });
+        }
+    }
+
+    std::size_t num_coverable() const { return order.size(); }
+    std::size_t max_letters() const { return maxLetters; }
+    std::uint32_t letters(const std::uint32_t set) const { return letterSets[set]; }
+    std::uint32_t first_word(const std::uint32_t set) const { return firstWords[set]; }
+
+    // Sets covering at least target letters into chosen; false if there are none.
+    bool find(const std::size_t target, const std::size_t numThreads, std::vector<std::uint32_t>& chosen) const
+    {
+        SearchRun run;
+        run.target = target;
+        run.maxSkipped = order.size() - target;
+        if (numThreads == 1) {
+            return search(0, 0, 0, chosen, run);
+        }
+
+        // The tasks come out in the order one thread would search them, so
+        // the first of them with a cover has the cover one thread finds.
+        std::vector<SearchState> tasks;
+        run.tasks = &tasks;
+        for (run.splitLevel = 1;; run.splitLevel++) {
+            tasks.clear();
+            chosen.clear();
+            const bool found = search(0, 0, 0, chosen, run);
+            if (found || tasks.empty() || (tasks.size() >= numThreads * TASKS_PER_THREAD)
+                    || (run.splitLevel >= count + run.maxSkipped)) {
+                break;
+            }
+        }
+        run.tasks = nullptr;
+
+        std::atomic<std::size_t> firstFound{tasks.size()};
+        std::vector<std::vector<std::uint32_t>> covers(tasks.size());
+        parallel_for_dynamic(tasks.size(), numThreads, 1, [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t t = begin; t < end; t++) {
+                SearchRun taskRun = run;
+                taskRun.firstFound = &firstFound;
+                taskRun.taskIndex = t;
+                const SearchState& task = tasks[t];
+                covers[t] = task.chosen;
+                if (search(task.covered, task.skipped, task.next, covers[t], taskRun)) {
+                    std::size_t first = firstFound.load();
+                    while ((t < first) && !firstFound.compare_exchange_weak(first, t)) {
+                    }
+                }
+            }
+        });
+        if (firstFound.load() == tasks.size()) {
+            return false;
+        }
+        chosen = covers[firstFound.load()];
+        return true;
+    }
+
+private:
+    bool search(const std::uint32_t covered, const std::uint32_t skipped, std::size_t next,
+            std::vector<std::uint32_t>& chosen, const SearchRun& run) const
+    {
+        const std::uint32_t settled = covered | skipped;
+        while ((next < order.size()) && (((settled >> order[next]) & 1) != 0)) {
+            next++;
+        }
+        const std::size_t numCovered = __builtin_popcount(covered);
+        const std::size_t numSkipped = __builtin_popcount(skipped);
+        const bool found = numCovered >= run.target;
+        if ((run.tasks != nullptr) && (found || (chosen.size() + numSkipped == run.splitLevel))) {
+            run.tasks->push_back(SearchState{covered, skipped, next, chosen});
+            return found;
+        }
+        if (found) {
+            return true;
+        }
+        const std::size_t remaining = count - chosen.size();
+        if ((remaining == 0) || (next == order.size()) || (numCovered + (remaining * maxLetters) < run.target)) {
+            return false;
+        }
+        if ((run.firstFound != nullptr) && (run.firstFound->load(std::memory_order_relaxed) < run.taskIndex)) {
+            return false;
+        }
+
+        // The rarest letter not yet settled is either in the next word...
+        for (const std::uint32_t set : buckets[next]) {
+            const std::uint32_t letters = letterSets[set];
+            if (((letters & skipped) != 0)
+                    || (__builtin_popcount(covered | letters) + ((remaining - 1) * maxLetters) < run.target)) {
+                continue;
+            }
+            chosen.push_back(set);
+            if (search(covered | letters, skipped, next + 1, chosen, run)) {
+                return true;
+            }
+            chosen.pop_back();
+        }
+        // ... or in none of them.
+        return (numSkipped < run.maxSkipped)
+            && search(covered, skipped | (1u << order[next]), next + 1, chosen, run);
+    }
+
+    const std::size_t count;
+    // The distinct untested letter sets of the words, and the first word of each.
+    std::vector<std::uint32_t> letterSets;
+    std::vector<std::uint32_t> firstWords;
+    std::uint32_t coverableLetters = 0;
+    std::size_t maxLetters = 0;
+    // The coverable letters, rarest first, and for each the sets containing it.
+    std::vector<std::size_t> order;
+    std::vector<std::vector<std::uint32_t>> buckets;
+};
+
+} // namespace
+
+Cover find_cover(const PackedView& words, const std::uint32_t testedLetters, const std::size_t count,
+        const std::size_t numThreads)
+{
+    const CoverSearch search(words, testedLetters, count);
+    Cover cover;
+    // The largest target that can be met is the answer.
+    for (std::size_t target = std::min(search.num_coverable(), count * search.max_letters()); target > 0; target--) {
+        std::vector<std::uint32_t> chosen;
+        if (search.find(target, std::max<std::size_t>(1, numThreads), chosen)) {
+            for (const std::uint32_t set : chosen) {
+                cover.words.push_back(search.first_word(set));
+                cover.letters |= search.letters(set);
+            }
+            std::sort(cover.words.begin(), cover.words.end());
+            break;
+        }
+    }
+    return cover;
+}
+
+} // namespace set_solver
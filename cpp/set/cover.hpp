@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "packed_words.hpp"
+
+namespace set_solver {
+
+struct Cover {
+    // Indices of the words, in list order: at most `count`, fewer if fewer
+    // already cover every letter that can be covered.
+    std::vector<std::uint32_t> words;
+    // The letters they contain that were not tested yet.
+    std::uint32_t letters = 0;
+};
+
+// --cover k: the k words of `words` that together contain the most letters
+// outside testedLetters (excluded, required, known or already guessed), as
+// elimination guesses. Ties go to the set found first, which does not
+// depend on numThreads.
+//
+// Words with the same untested letters are searched once. The search is a
+// branch and bound over letters from the rarest up: the rarest letter not
+// yet settled is either in the next word chosen or never covered, and a
+// branch is cut once even k - chosen words of the most letters could not
+// reach the target. Its top levels are spread over numThreads threads.
+Cover find_cover(const PackedView& words, std::uint32_t testedLetters, std::size_t count, std::size_t numThreads);
+
+} // namespace set_solver
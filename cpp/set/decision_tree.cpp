@@ -0,0 +1,379 @@
+#include "decision_tree.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <sys/mman.h>
+#include <unordered_set>
+#include <utility>
+
+#include "args.hpp"
+#include "constraints.hpp"
+#include "feedback.hpp"
+#include "feedback_table.hpp"
+#include "parallel.hpp"
+#include "word_index.hpp"
+
+namespace set_solver {
+
+namespace {
+
+constexpr char TREE_MAGIC[8] = {'W', 'R', 'D', 'L', 'T', 'R', 'E', '\0'};
+constexpr std::size_t SECTION_ALIGNMENT = 64;
+
+constexpr std::uint64_t NO_PROGRESS = std::numeric_limits<std::uint64_t>::max();
+
+std::size_t align_up(const std::size_t n)
+{
+    return (n + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// The candidates left after each feedback pattern of a guess, in pattern
+// order. A candidate that is the guess itself (up to case) is solved and
+// left out.
+using Partition = std::vector<std::pair<std::uint8_t, std::vector<std::uint32_t>>>;
+
+struct BuiltNode {
+    std::uint32_t guess = 0;
+    // Answers that reach this node and are the guess, up to case: 0 or 1,
+    // as the answers have distinct codes.
+    std::uint32_t numSolved = 0;
+    std::vector<std::pair<std::uint8_t, std::unique_ptr<BuiltNode>>> children;
+};
+
+class TreeBuilder {
+public:
+    TreeBuilder(const PackedView& words, const GuessScore score, const std::size_t width)
+        : words(words), score(score), width(width), feedback(select_feedback_kernel())
+    {
+    }
+
+    std::unique_ptr<BuiltNode> build(const std::vector<std::uint32_t>& candidates, const std::size_t depth,
+            const std::size_t numThreads) const
+    {
+        auto node = std::make_unique<BuiltNode>();
+        node->guess = choose(candidates, depth, numThreads, nullptr);
+        node->numSolved = static_cast<std::uint32_t>(std::count_if(candidates.begin(), candidates.end(),
+            [&](const std::uint32_t c) { return words.codes[c] == words.codes[node->guess]; }));
+        const Partition parts = partition(node->guess, candidates);
+        node->children.resize(parts.size());
+        parallel_for_dynamic(parts.size(), numThreads, 1, [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t p = begin; p < end; p++) {
+                node->children[p] = {parts[p].first, build(parts[p].second, depth, 1)};
+            }
+        });
+        return node;
+    }
+
+private:
+    // The guess to play against candidates. Unless cost is null, it is set
+    // to the guesses it then takes to solve all of them.
+    std::uint32_t choose(const std::vector<std::uint32_t>& candidates, const std::size_t depth,
+            const std::size_t numThreads, std::uint64_t* cost) const
+    {
+        // One candidate left, or two: guessing one of them is never worse.
+        if (candidates.size() <= 2) {
+            if (cost != nullptr) {
+                *cost = (2 * candidates.size()) - 1;
+            }
+            return candidates.front();
+        }
+        const std::vector<Suggestion> best =
+            suggest_guesses(words, candidates, score, depth > 0 ? width : 1, numThreads);
+        // With no alternatives there is nothing to compare.
+        if ((best.size() == 1) && (cost == nullptr)) {
+            return best.front().word;
+        }
+        std::uint32_t guess = best.front().word;
+        std::uint64_t bestCost = NO_PROGRESS;
+        for (const Suggestion& suggestion : best) {
+            const std::uint64_t guessCost =
+                cost_after(suggestion.word, candidates, depth > 0 ? depth - 1 : 0, numThreads);
+            if (guessCost < bestCost) {
+                guess = suggestion.word;
+                bestCost = guessCost;
+            }
+        }
+        if (cost != nullptr) {
+            *cost = bestCost;
+        }
+        return guess;
+    }
+
+    // Guesses to solve every candidate when guess is played first.
+    std::uint64_t cost_after(const std::uint32_t guess, const std::vector<std::uint32_t>& candidates,
+            const std::size_t depth, const std::size_t numThreads) const
+    {
+        const Partition parts = partition(guess, candidates);
+        if ((parts.size() == 1) && (parts.front().second.size() == candidates.size())) {
+            return NO_PROGRESS;
+        }
+        std::vector<std::uint64_t> costs(parts.size(), 0);
+        parallel_for_dynamic(parts.size(), numThreads, 1, [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t p = begin; p < end; p++) {
+                choose(parts[p].second, depth, 1, &costs[p]);
+            }
+        });
+        // A part that makes no progress makes none for the whole guess,
+        // rather than wrapping the sum around.
+        std::uint64_t total = candidates.size();
+        for (const std::uint64_t partCost : costs) {
+            if (partCost == NO_PROGRESS) {
+                return NO_PROGRESS;
+            }
+            total += partCost;
+        }
+        return total;
+    }
+
+    Partition partition(const std::uint32_t guess, const std::vector<std::uint32_t>& candidates) const
+    {
+        std::vector<std::uint32_t> codes(candidates.size());
+        std::vector<std::uint8_t> patterns(candidates.size());
+        for (std::size_t c = 0; c < candidates.size(); c++) {
+            codes[c] = words.codes[candidates[c]];
+        }
+        feedback(words.codes[guess], codes.data(), codes.size(), patterns.data());
+
+        std::array<std::uint32_t, NUM_PATTERNS> counts{};
+        for (const std::uint8_t pattern : patterns) {
+            counts[pattern]++;
+        }
+        std::array<std::uint32_t, NUM_PATTERNS> slot{};
+        Partition parts;
+        for (std::size_t p = 0; p < ALL_GREEN; p++) {
+            if (counts[p] > 0) {
+                slot[p] = static_cast<std::uint32_t>(parts.size());
+                parts.emplace_back(static_cast<std::uint8_t>(p), std::vector<std::uint32_t>());
+                parts.back().second.reserve(counts[p]);
+            }
+        }
+        for (std::size_t c = 0; c < candidates.size(); c++) {
+            if (patterns[c] != ALL_GREEN) {
+                parts[slot[patterns[c]]].second.push_back(candidates[c]);
+            }
+        }
+        return parts;
+    }
+
+    const PackedView words;
+    const GuessScore score;
+    const std::size_t width;
+    const FeedbackKernel feedback;
+};
+
+// Lay the tree out breadth first, so that every node's children are
+// consecutive, and add up the guesses each answer takes.
+std::vector<DecisionNode> flatten(const PackedView& words, const BuiltNode& root, DecisionTreeHeader& header)
+{
+    std::vector<DecisionNode> nodes;
+    std::deque<std::pair<const BuiltNode*, std::uint64_t>> queue = {{&root, 1}};
+    while (!queue.empty()) {
+        const auto [built, level] = queue.front();
+        queue.pop_front();
+        DecisionNode node;
+        std::memset(&node, 0, sizeof(node));
+        node.guess = words.codes[built->guess];
+        node.firstChild = static_cast<std::uint32_t>(nodes.size() + queue.size() + 1);
+        for (const auto& [pattern, child] : built->children) {
+            node.patterns[pattern / 64] |= std::uint64_t{1} << (pattern % 64);
+            queue.emplace_back(child.get(), level + 1);
+        }
+        nodes.push_back(node);
+        if (built->numSolved > 0) {
+            header.totalGuesses += level * built->numSolved;
+            header.maxGuesses = std::max(header.maxGuesses, level);
+        }
+    }
+    return nodes;
+}
+
+bool write_tree(FILE* file, const DecisionTreeHeader& header, const std::vector<DecisionNode>& nodes)
+{
+    const std::vector<char> padding(header.nodeOffset - sizeof(header), 0);
+    return (std::fwrite(&header, 1, sizeof(header), file) == sizeof(header))
+        && (std::fwrite(padding.data(), 1, padding.size(), file) == padding.size())
+        && (std::fwrite(nodes.data(), sizeof(DecisionNode), nodes.size(), file) == nodes.size());
+}
+
+std::string unpack_word(const std::uint32_t code)
+{
+    std::string word(WORDLE_WORD_LEN, 'a');
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        word[i] = static_cast<char>('a' + letter_at(code, i));
+    }
+    return word;
+}
+
+} // namespace
+
+DecisionTree::~DecisionTree()
+{
+    close();
+}
+
+bool DecisionTree::open(const std::string& treePath, std::ostream& err)
+{
+    close();
+    void* data = nullptr;
+    std::size_t size = 0;
+    if (!map_file(treePath, data, size)) {
+        err << "Error when trying to open \"" << treePath << "\".\n";
+        return false;
+    }
+
+    const DecisionTreeHeader* h = static_cast<const DecisionTreeHeader*>(data);
+    const bool valid = (size >= sizeof(DecisionTreeHeader))
+        && (std::memcmp(h->magic, TREE_MAGIC, sizeof(TREE_MAGIC)) == 0)
+        && (h->version == DECISION_TREE_VERSION)
+        && (h->headerSize == sizeof(DecisionTreeHeader))
+        && (h->numNodes > 0)
+        && (h->nodeOffset <= size)
+        && (h->numNodes <= (size - h->nodeOffset) / sizeof(DecisionNode));
+    if (!valid) {
+        err << "Error: \"" << treePath << "\" is not a decision tree or is from an older version.\n";
+        if (data != nullptr) {
+            ::munmap(data, size);
+        }
+        return false;
+    }
+    mapping = data;
+    mappingSize = size;
+    image = static_cast<const char*>(data);
+    return true;
+}
+
+void DecisionTree::close()
+{
+    if (mapping != nullptr) {
+        ::munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    image = nullptr;
+}
+
+const DecisionTreeHeader* DecisionTree::header() const
+{
+    return reinterpret_cast<const DecisionTreeHeader*>(image);
+}
+
+const DecisionNode* DecisionTree::root() const
+{
+    return reinterpret_cast<const DecisionNode*>(image + header()->nodeOffset);
+}
+
+const DecisionNode* DecisionTree::child(const DecisionNode* node, const std::uint8_t pattern) const
+{
+    const std::size_t word = pattern / 64;
+    const std::uint64_t bit = std::uint64_t{1} << (pattern % 64);
+    if ((pattern >= NUM_PATTERNS) || ((node->patterns[word] & bit) == 0)) {
+        return nullptr;
+    }
+    std::size_t rank = __builtin_popcountll(node->patterns[word] & (bit - 1));
+    for (std::size_t w = 0; w < word; w++) {
+        rank += __builtin_popcountll(node->patterns[w]);
+    }
+    const std::size_t index = node->firstChild + rank;
+    return index < header()->numNodes ? root() + index : nullptr;
+}
+
+std::string get_decision_tree_path(const std::string& answerPath)
+{
+    return answerPath + ".tree";
+}
+
+bool build_decision_tree(const PackedView& words, const std::vector<std::uint32_t>& answers, const GuessScore score,
+        const std::size_t width, const std::size_t depth, const std::size_t numThreads, const std::string& treePath,
+        DecisionTreeHeader& header, std::ostream& err)
+{
+    if (answers.empty()) {
+        err << "Error: There are no answers to build a decision tree for.\n";
+        return false;
+    }
+    // Words that differ only in case are one answer: a guess solves both,
+    // and a set of identical candidates could never be split.
+    std::vector<std::uint32_t> distinctAnswers;
+    std::unordered_set<std::uint32_t> seen;
+    for (const std::uint32_t answer : answers) {
+        if (seen.insert(words.codes[answer]).second) {
+            distinctAnswers.push_back(answer);
+        }
+    }
+    const TreeBuilder builder(words, score, std::max<std::size_t>(1, width));
+    const std::unique_ptr<BuiltNode> root = builder.build(distinctAnswers, depth, numThreads);
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TREE_MAGIC, sizeof(TREE_MAGIC));
+    header.version = DECISION_TREE_VERSION;
+    header.headerSize = sizeof(DecisionTreeHeader);
+    header.guessHash = hash_words(words);
+    std::vector<std::uint32_t> answerCodes(distinctAnswers.size());
+    for (std::size_t a = 0; a < distinctAnswers.size(); a++) {
+        answerCodes[a] = words.codes[distinctAnswers[a]];
+    }
+    header.answerHash = hash_words(PackedView{answerCodes.data(), nullptr, answerCodes.size()});
+    header.numAnswers = distinctAnswers.size();
+    header.nodeOffset = align_up(sizeof(DecisionTreeHeader));
+    const std::vector<DecisionNode> nodes = flatten(words, *root, header);
+    header.numNodes = nodes.size();
+
+    std::string tmpPath;
+    FILE* file = create_temp_file(treePath, tmpPath);
+    if (file == nullptr) {
+        err << "Error: Unable to write the decision tree \"" << treePath << "\".\n";
+        return false;
+    }
+    if (!publish_temp_file(file, tmpPath, treePath, write_tree(file, header, nodes))) {
+        err << "Error: Unable to write the decision tree \"" << treePath << "\".\n";
+        return false;
+    }
+    return true;
+}
+
+int run_tree_lookup(const std::string& treePath, const std::vector<std::string>& args,
+        std::ostream& out, std::ostream& err)
+{
+    DecisionTree tree;
+    if (!tree.open(treePath, err)) {
+        return EXIT_FAILURE;
+    }
+    const DecisionNode* node = tree.root();
+    for (const std::string& guessParam : get_arg_params(args, "-guess")) {
+        std::string guess;
+        std::string feedback;
+        std::uint8_t pattern = 0;
+        if (!split_guess_param(guessParam, guess, feedback) || (guess.length() != WORDLE_WORD_LEN)
+                || !parse_feedback(feedback, pattern)) {
+            err << "Error: Expected -guess <word>:<feedback>, e.g. -guess crane:gybbg.\n";
+            return EXIT_FAILURE;
+        }
+        if (node == nullptr) {
+            err << "Error: The game was already solved.\n";
+            return EXIT_FAILURE;
+        }
+        if (pack_code(guess) != node->guess) {
+            err << "Error: The tree plays \"" << unpack_word(node->guess) << "\" here, not \"" << guess << "\".\n";
+            return EXIT_FAILURE;
+        }
+        pattern = canonical_feedback(node->guess, pattern);
+        if (pattern == ALL_GREEN) {
+            node = nullptr;
+            continue;
+        }
+        node = tree.child(node, pattern);
+        if (node == nullptr) {
+            err << "Error: No answer the tree was built for gives this feedback.\n";
+            return EXIT_FAILURE;
+        }
+    }
+    out << (node != nullptr ? unpack_word(node->guess) : "Solved.") << "\n";
+    return EXIT_SUCCESS;
+}
+
+} // namespace set_solver
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "packed_words.hpp"
+#include "suggest.hpp"
+
+namespace set_solver {
+
+// Bump whenever the layout of DecisionTreeHeader or DecisionNode changes.
+constexpr std::uint32_t DECISION_TREE_VERSION = 1;
+
+// Fixed-size header at the start of every decision tree file. numNodes
+// DecisionNodes follow at nodeOffset, the root first and every node's
+// children together, so the file is used as mapped. The hashes identify
+// the word lists the tree was built for; totalGuesses (over all answers)
+// and maxGuesses describe how well it plays.
+struct DecisionTreeHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t guessHash;
+    std::uint64_t answerHash;
+    std::uint64_t numAnswers;
+    std::uint64_t numNodes;
+    std::uint64_t nodeOffset;
+    std::uint64_t totalGuesses;
+    std::uint64_t maxGuesses;
+};
+
+// One guess of the tree and the nodes its feedback patterns lead to.
+struct DecisionNode {
+    // Bit p set if pattern p leaves answers to play on (all green never does).
+    std::uint64_t patterns[4];
+    // The guess to play, packed.
+    std::uint32_t guess;
+    // Index of the node after the lowest of the patterns; those after the
+    // others follow in pattern order.
+    std::uint32_t firstChild;
+};
+
+// A memory-mapped decision tree.
+class DecisionTree {
+public:
+    DecisionTree() = default;
+    ~DecisionTree();
+    DecisionTree(const DecisionTree&) = delete;
+    DecisionTree& operator=(const DecisionTree&) = delete;
+
+    bool open(const std::string& treePath, std::ostream& err);
+    void close();
+
+    const DecisionTreeHeader* header() const;
+    const DecisionNode* root() const;
+
+    // The node after node's guess got pattern: a bit test and a popcount.
+    // nullptr if no answer gives that pattern.
+    const DecisionNode* child(const DecisionNode* node, std::uint8_t pattern) const;
+
+private:
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    const char* image = nullptr;
+};
+
+// "words.txt" -> "words.txt.tree"
+std::string get_decision_tree_path(const std::string& answerPath);
+
+// Build-tree mode: a tree of guesses from `words` that solves every one of
+// answers (indices into words), written to treePath. At each node the
+// `width` best guesses by score are each tried with the nodes below them
+// searched `depth` levels less deep, and the one needing the fewest guesses
+// in total is kept; at depth 0 the best guess by score is played. Only the
+// answers are candidates, so that is simulate mode's strategy only when
+// answers are all of words; answers that differ only in case count once.
+// Subtrees are searched on numThreads threads. On success header describes
+// the tree written.
+bool build_decision_tree(const PackedView& words, const std::vector<std::uint32_t>& answers, GuessScore score,
+        std::size_t width, std::size_t depth, std::size_t numThreads, const std::string& treePath,
+        DecisionTreeHeader& header, std::ostream& err);
+
+// --tree=words.txt.tree: follow the -guess history down the tree and print
+// the next guess, without loading or scoring the word list.
+int run_tree_lookup(const std::string& treePath, const std::vector<std::string>& args,
+        std::ostream& out, std::ostream& err);
+
+} // namespace set_solver
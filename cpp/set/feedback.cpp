@@ -0,0 +1,178 @@
+#include "feedback.hpp"
+
+#include <algorithm>
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+
+namespace set_solver {
+
+namespace {
+
+void feedback_scalar(const std::uint32_t guess, const std::uint32_t* answers, const std::size_t count,
+        std::uint8_t* patterns)
+{
+    for (std::size_t a = 0; a < count; a++) {
+        patterns[a] = compute_feedback(guess, answers[a]);
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+
+// Bit 4 and bits 0-3 of every 5-bit letter field of a packed code.
+constexpr std::uint32_t FIELD_HIGH_BITS = 0x1084210;
+constexpr std::uint32_t FIELD_LOW_BITS = 0x0F7BDEF;
+// One in every letter field: letter * FIELD_ONES repeats it 5 times.
+constexpr std::uint32_t FIELD_ONES = 0x108421;
+
+// FIELD_HIGH_BITS set in every field of x that is not zero.
+__attribute__((target("avx2")))
+inline __m256i nonzero_fields(const __m256i x)
+{
+    const __m256i low = _mm256_set1_epi32(FIELD_LOW_BITS);
+    const __m256i carried = _mm256_add_epi32(_mm256_and_si256(x, low), low);
+    return _mm256_and_si256(_mm256_or_si256(carried, x), _mm256_set1_epi32(FIELD_HIGH_BITS));
+}
+
+// Number of FIELD_HIGH_BITS set in x (at most 5, so the sums cannot carry
+// into the next field).
+__attribute__((target("avx2")))
+inline __m256i count_fields(const __m256i x)
+{
+    const __m256i sums = _mm256_mullo_epi32(_mm256_srli_epi32(x, 4), _mm256_set1_epi32(FIELD_ONES));
+    return _mm256_and_si256(_mm256_srli_epi32(sums, 20), _mm256_set1_epi32(7));
+}
+
+// A letter of the guess that is not green is yellow when the answer has
+// more unmatched copies of it than the guess has used up to its left:
+//   copies = answer positions with the letter where the guess has another letter
+//   used   = guess positions to the left with the letter where the answer has another letter
+// Both are counted for 8 answers at a time with SWAR tests on the codes.
+__attribute__((target("avx2")))
+void feedback_avx2(const std::uint32_t guess, const std::uint32_t* answers, const std::size_t count,
+        std::uint8_t* patterns)
+{
+    __m256i repeated[WORDLE_WORD_LEN];
+    __m256i samePositions[WORDLE_WORD_LEN];
+    __m256i leftPositions[WORDLE_WORD_LEN];
+    bool hasLeft[WORDLE_WORD_LEN];
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        std::uint32_t same = 0;
+        std::uint32_t left = 0;
+        for (std::size_t j = 0; j < WORDLE_WORD_LEN; j++) {
+            if (letter_at(guess, j) == letter_at(guess, i)) {
+                same |= 0x10u << (LETTER_BITS * j);
+                left |= (j < i) ? (0x10u << (LETTER_BITS * j)) : 0;
+            }
+        }
+        repeated[i] = _mm256_set1_epi32(static_cast<int>(letter_at(guess, i) * FIELD_ONES));
+        samePositions[i] = _mm256_set1_epi32(static_cast<int>(same));
+        leftPositions[i] = _mm256_set1_epi32(static_cast<int>(left));
+        hasLeft[i] = left != 0;
+    }
+
+    const __m256i guessCodes = _mm256_set1_epi32(static_cast<int>(guess));
+    const __m256i highBits = _mm256_set1_epi32(FIELD_HIGH_BITS);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    // Byte 0 of every 32-bit lane, gathered into the low 8 bytes.
+    const __m256i lowBytes = _mm256_setr_epi8(
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i lowDwords = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+
+    // The last (partial) group of 8 is computed from a padded copy.
+    std::uint32_t tail[8] = {};
+    std::uint8_t tailPatterns[8];
+    for (std::size_t a = 0; a < count; a += 8) {
+        const bool partial = a + 8 > count;
+        if (partial) {
+            std::copy(answers + a, answers + count, tail);
+        }
+        const __m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(partial ? tail : answers + a));
+        const __m256i green = _mm256_andnot_si256(nonzero_fields(_mm256_xor_si256(codes, guessCodes)), highBits);
+        __m256i pattern = _mm256_setzero_si256();
+        for (std::size_t k = WORDLE_WORD_LEN; k-- > 0;) {
+            const __m256i equal = _mm256_andnot_si256(nonzero_fields(_mm256_xor_si256(codes, repeated[k])), highBits);
+            const __m256i copies = count_fields(_mm256_andnot_si256(samePositions[k], equal));
+            const __m256i used = hasLeft[k]
+                ? count_fields(_mm256_andnot_si256(equal, leftPositions[k]))
+                : _mm256_setzero_si256();
+            const __m256i yellow = _mm256_and_si256(_mm256_cmpgt_epi32(copies, used), one);
+            const __m256i isGreen = _mm256_and_si256(_mm256_srli_epi32(green, (LETTER_BITS * k) + 3), two);
+            const __m256i value = _mm256_max_epu32(yellow, isGreen);
+            pattern = _mm256_add_epi32(_mm256_add_epi32(pattern, _mm256_add_epi32(pattern, pattern)), value);
+        }
+        const __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pattern, lowBytes), lowDwords);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(partial ? tailPatterns : patterns + a), _mm256_castsi256_si128(bytes));
+        if (partial) {
+            std::copy(tailPatterns, tailPatterns + (count - a), patterns + a);
+        }
+    }
+}
+
+#endif // HAVE_X86_KERNELS
+
+} // namespace
+
+bool parse_feedback(const std::string_view feedback, std::uint8_t& pattern)
+{
+    if (feedback.length() != WORDLE_WORD_LEN) {
+        return false;
+    }
+    unsigned int value = 0;
+    unsigned int weight = 1;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++, weight *= 3) {
+        switch (feedback[i] | 0x20) {
+        case 'b':
+            break;
+        case 'y':
+            value += weight;
+            break;
+        case 'g':
+            value += 2 * weight;
+            break;
+        default:
+            return false;
+        }
+    }
+    pattern = static_cast<std::uint8_t>(value);
+    return true;
+}
+
+std::uint8_t canonical_feedback(const std::uint32_t guess, const std::uint8_t pattern)
+{
+    unsigned int digits[WORDLE_WORD_LEN];
+    std::array<std::uint8_t, 26> yellows{};
+    unsigned int value = pattern;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++, value /= 3) {
+        digits[i] = value % 3;
+        yellows[letter_at(guess, i)] += digits[i] == 1;
+    }
+    unsigned int canonical = 0;
+    unsigned int weight = 1;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++, weight *= 3) {
+        if (digits[i] == 2) {
+            canonical += 2 * weight;
+        } else if (yellows[letter_at(guess, i)] > 0) {
+            yellows[letter_at(guess, i)]--;
+            canonical += weight;
+        }
+    }
+    return static_cast<std::uint8_t>(canonical);
+}
+
+FeedbackKernel select_feedback_kernel()
+{
+#ifdef HAVE_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return feedback_avx2;
+    }
+#endif
+    return feedback_scalar;
+}
+
+} // namespace set_solver
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "packed_words.hpp"
+
+namespace set_solver {
+
+// Wordle feedback for a guess as a base-3 number: digit i (weight 3^i)
+// is 0 for black, 1 for yellow and 2 for green, so 3^5 = 243 patterns.
+constexpr std::size_t NUM_PATTERNS = 243;
+constexpr std::uint8_t ALL_GREEN = NUM_PATTERNS - 1;
+
+// Feedback for guessing `guess` when the answer is `answer`, both packed.
+// Greens are assigned first; each remaining letter of the answer can then
+// turn at most one guess letter yellow, left to right, as in Wordle.
+inline std::uint8_t compute_feedback(const std::uint32_t guess, const std::uint32_t answer)
+{
+    std::uint32_t guessLetters[WORDLE_WORD_LEN];
+    std::uint32_t answerLetters[WORDLE_WORD_LEN];
+    unsigned int unmatched = 0;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        guessLetters[i] = letter_at(guess, i);
+        answerLetters[i] = letter_at(answer, i);
+        unmatched |= (guessLetters[i] != answerLetters[i]) << i;
+    }
+
+    unsigned int pattern = 0;
+    unsigned int weight = 1;
+    unsigned int available = unmatched;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++, weight *= 3) {
+        if (((unmatched >> i) & 1) == 0) {
+            pattern += 2 * weight;
+            continue;
+        }
+        for (std::size_t j = 0; j < WORDLE_WORD_LEN; j++) {
+            if (((available >> j) & 1) && (answerLetters[j] == guessLetters[i])) {
+                pattern += weight;
+                available &= ~(1u << j);
+                break;
+            }
+        }
+    }
+    return static_cast<std::uint8_t>(pattern);
+}
+
+
+// "gybbg" -> pattern (case-insensitive); false unless it is 5 of g/y/b.
+bool parse_feedback(std::string_view feedback, std::uint8_t& pattern);
+
+// The pattern Wordle itself gives for feedback on guess with the same
+// greens and the same number of yellows per letter: a repeated letter's
+// yellows moved to its first non-green occurrences ("eerie:bybbb" ->
+// "ybbbb"). Both describe the same answers, as Constraints only counts
+// them, but only this one can equal compute_feedback.
+std::uint8_t canonical_feedback(std::uint32_t guess, std::uint8_t pattern);
+
+// Feedback for one guess against many answers:
+// patterns[a] = compute_feedback(guess, answers[a]) for a < count.
+using FeedbackKernel = void (*)(std::uint32_t guess, const std::uint32_t* answers, std::size_t count,
+        std::uint8_t* patterns);
+
+// The widest feedback kernel the CPU supports (AVX2, then scalar).
+FeedbackKernel select_feedback_kernel();
+
+} // namespace set_solver
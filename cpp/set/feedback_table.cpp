@@ -0,0 +1,193 @@
+#include "feedback_table.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+
+#include "feedback.hpp"
+#include "parallel.hpp"
+#include "word_index.hpp"
+
+namespace set_solver {
+
+namespace {
+
+constexpr char TABLE_MAGIC[8] = {'W', 'R', 'D', 'L', 'F', 'B', 'T', '\0'};
+constexpr std::size_t SECTION_ALIGNMENT = 64;
+
+// Rows computed between two writes: 8 MB of patterns for 16k answers.
+constexpr std::size_t ROWS_PER_BLOCK = 512;
+
+std::size_t align_up(const std::size_t n)
+{
+    return (n + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+bool write_at(FILE* file, const std::uint64_t offset, const void* data, const std::size_t size)
+{
+    return (std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0)
+        && (std::fwrite(data, 1, size, file) == size);
+}
+
+bool write_table(FILE* file, const PackedView& guesses, const PackedView& answers, const std::size_t numThreads)
+{
+    FeedbackTableHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC));
+    header.version = FEEDBACK_TABLE_VERSION;
+    header.headerSize = sizeof(FeedbackTableHeader);
+    header.guessHash = hash_words(guesses);
+    header.answerHash = hash_words(answers);
+    header.numGuesses = guesses.size();
+    header.numAnswers = answers.size();
+    header.rowStride = align_up(answers.size());
+    header.guessOffset = align_up(sizeof(FeedbackTableHeader));
+    header.answerOffset = align_up(header.guessOffset + (guesses.size() * sizeof(std::uint32_t)));
+    header.sortedOffset = align_up(header.answerOffset + (answers.size() * sizeof(std::uint32_t)));
+    header.patternOffset = align_up(header.sortedOffset + (guesses.size() * sizeof(std::uint32_t)));
+
+    std::vector<std::uint32_t> sortedRows(guesses.size());
+    for (std::size_t g = 0; g < sortedRows.size(); g++) {
+        sortedRows[g] = static_cast<std::uint32_t>(g);
+    }
+    std::stable_sort(sortedRows.begin(), sortedRows.end(),
+        [&](const std::uint32_t a, const std::uint32_t b) { return guesses.codes[a] < guesses.codes[b]; });
+
+    if (!write_at(file, 0, &header, sizeof(header))
+            || !write_at(file, header.guessOffset, guesses.codes, guesses.size() * sizeof(std::uint32_t))
+            || !write_at(file, header.answerOffset, answers.codes, answers.size() * sizeof(std::uint32_t))
+            || !write_at(file, header.sortedOffset, sortedRows.data(), sortedRows.size() * sizeof(std::uint32_t))
+            || (std::fseek(file, static_cast<long>(header.patternOffset), SEEK_SET) != 0)) {
+        return false;
+    }
+
+    const FeedbackKernel feedback = select_feedback_kernel();
+    std::vector<std::uint8_t> block(ROWS_PER_BLOCK * header.rowStride, 0);
+    for (std::size_t first = 0; first < guesses.size(); first += ROWS_PER_BLOCK) {
+        const std::size_t numRows = std::min(ROWS_PER_BLOCK, guesses.size() - first);
+        parallel_for_dynamic(numRows, numThreads, 1, [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t r = begin; r < end; r++) {
+                feedback(guesses.codes[first + r], answers.codes, answers.size(), &block[r * header.rowStride]);
+            }
+        });
+        const std::size_t blockBytes = numRows * header.rowStride;
+        if (std::fwrite(block.data(), 1, blockBytes, file) != blockBytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::uint64_t hash_words(const PackedView& words)
+{
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (std::size_t w = 0; w < words.size(); w++) {
+        for (std::size_t byte = 0; byte < sizeof(std::uint32_t); byte++) {
+            hash = (hash ^ ((words.codes[w] >> (8 * byte)) & 0xff)) * 0x100000001b3;
+        }
+    }
+    return hash;
+}
+
+FeedbackTable::~FeedbackTable()
+{
+    close();
+}
+
+bool FeedbackTable::open(const std::string& tablePath, std::ostream& err)
+{
+    close();
+    void* data = nullptr;
+    std::size_t size = 0;
+    if (!map_file(tablePath, data, size)) {
+        err << "Error when trying to open \"" << tablePath << "\".\n";
+        return false;
+    }
+
+    const FeedbackTableHeader* h = static_cast<const FeedbackTableHeader*>(data);
+    const bool valid = (size >= sizeof(FeedbackTableHeader))
+        && (std::memcmp(h->magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) == 0)
+        && (h->version == FEEDBACK_TABLE_VERSION)
+        && (h->headerSize == sizeof(FeedbackTableHeader))
+        && (h->rowStride >= h->numAnswers)
+        && (h->guessOffset + (h->numGuesses * sizeof(std::uint32_t)) <= size)
+        && (h->answerOffset + (h->numAnswers * sizeof(std::uint32_t)) <= size)
+        && (h->sortedOffset + (h->numGuesses * sizeof(std::uint32_t)) <= size)
+        && (h->patternOffset <= size)
+        && ((h->rowStride == 0) || (h->numGuesses <= (size - h->patternOffset) / h->rowStride));
+    if (!valid) {
+        err << "Error: \"" << tablePath << "\" is not a feedback table or is from an older version.\n";
+        if (data != nullptr) {
+            ::munmap(data, size);
+        }
+        return false;
+    }
+    mapping = data;
+    mappingSize = size;
+    image = static_cast<const char*>(data);
+    return true;
+}
+
+void FeedbackTable::close()
+{
+    if (mapping != nullptr) {
+        ::munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    image = nullptr;
+}
+
+const FeedbackTableHeader* FeedbackTable::header() const
+{
+    return reinterpret_cast<const FeedbackTableHeader*>(image);
+}
+
+const std::uint8_t* FeedbackTable::row(const std::size_t guess) const
+{
+    return reinterpret_cast<const std::uint8_t*>(image + header()->patternOffset + (guess * header()->rowStride));
+}
+
+const std::uint8_t* FeedbackTable::find_row(const std::uint32_t guessCode) const
+{
+    const std::uint32_t* codes = reinterpret_cast<const std::uint32_t*>(image + header()->guessOffset);
+    const std::uint32_t* sortedRows = reinterpret_cast<const std::uint32_t*>(image + header()->sortedOffset);
+    const std::uint32_t* found = std::lower_bound(sortedRows, sortedRows + num_guesses(), guessCode,
+        [codes](const std::uint32_t g, const std::uint32_t code) { return codes[g] < code; });
+    if ((found == sortedRows + num_guesses()) || (*found >= num_guesses()) || (codes[*found] != guessCode)) {
+        return nullptr;
+    }
+    return row(*found);
+}
+
+std::string get_feedback_table_path(const std::string& wordFilePath)
+{
+    return wordFilePath + ".fbt";
+}
+
+bool build_feedback_table(const PackedView& guesses, const PackedView& answers,
+        const std::string& tablePath, const std::size_t numThreads, std::ostream& err)
+{
+    std::string tmpPath;
+    FILE* file = create_temp_file(tablePath, tmpPath);
+    if (file == nullptr) {
+        err << "Error: Unable to write the feedback table \"" << tablePath << "\".\n";
+        return false;
+    }
+    if (!publish_temp_file(file, tmpPath, tablePath, write_table(file, guesses, answers, numThreads))) {
+        err << "Error: Unable to write the feedback table \"" << tablePath << "\".\n";
+        return false;
+    }
+    return true;
+}
+
+void narrow_by_pattern(const std::uint8_t* row, const std::uint8_t pattern, std::vector<std::uint32_t>& candidates)
+{
+    const auto rejected = [row, pattern](const std::uint32_t a) { return row[a] != pattern; };
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), rejected), candidates.end());
+}
+
+} // namespace set_solver
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "packed_words.hpp"
+
+namespace set_solver {
+
+// Bump whenever the layout of FeedbackTableHeader or of the sections changes.
+constexpr std::uint32_t FEEDBACK_TABLE_VERSION = 2;
+
+// Fixed-size header at the start of every feedback table file.
+// The guess and answer codes (uint32 each) are stored at guessOffset and
+// answerOffset, and the row numbers of the guesses, ordered by code, at
+// sortedOffset for a binary search; row g of the matrix, at
+// patternOffset + g * rowStride, holds compute_feedback(guess g, answer a)
+// for every answer a in one byte.
+// The hashes identify the word lists the table was built for.
+struct FeedbackTableHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t guessHash;
+    std::uint64_t answerHash;
+    std::uint64_t numGuesses;
+    std::uint64_t numAnswers;
+    std::uint64_t rowStride;
+    std::uint64_t guessOffset;
+    std::uint64_t answerOffset;
+    std::uint64_t sortedOffset;
+    std::uint64_t patternOffset;
+};
+
+// FNV-1a hash of a packed word list, order included.
+std::uint64_t hash_words(const PackedView& words);
+
+// A memory-mapped feedback table.
+class FeedbackTable {
+public:
+    FeedbackTable() = default;
+    ~FeedbackTable();
+    FeedbackTable(const FeedbackTable&) = delete;
+    FeedbackTable& operator=(const FeedbackTable&) = delete;
+
+    bool open(const std::string& tablePath, std::ostream& err);
+    void close();
+
+    const FeedbackTableHeader* header() const;
+    std::size_t num_guesses() const { return header()->numGuesses; }
+    std::size_t num_answers() const { return header()->numAnswers; }
+
+    // Row of a guess, or nullptr if the guess is not in the table: a
+    // binary search of the guesses by code.
+    const std::uint8_t* find_row(std::uint32_t guessCode) const;
+    const std::uint8_t* row(std::size_t guess) const;
+
+private:
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    const char* image = nullptr;
+};
+
+// "words.txt" -> "words.txt.fbt"
+std::string get_feedback_table_path(const std::string& wordFilePath);
+
+// Build-feedback-table mode: compute the guesses x answers matrix and write
+// it to tablePath. Rows are computed a block at a time on numThreads threads
+// and each block is written out before the next is started.
+bool build_feedback_table(const PackedView& guesses, const PackedView& answers,
+        const std::string& tablePath, std::size_t numThreads, std::ostream& err);
+
+// Keep only the candidates (indices into the table's answers) for which the
+// row's guess would have produced pattern.
+void narrow_by_pattern(const std::uint8_t* row, std::uint8_t pattern, std::vector<std::uint32_t>& candidates);
+
+} // namespace set_solver
@@ -0,0 +1,159 @@
+#include "filter_kernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+
+namespace set_solver {
+
+namespace {
+
+std::size_t filter_range_scalar(const PackedView& words, const KernelQuery& query,
+        const std::size_t first, std::uint32_t* out)
+{
+    std::size_t count = 0;
+    const std::size_t n = words.size();
+    for (std::size_t i = first; i < n; i++) {
+        const std::uint32_t letters = words.letters[i];
+        const bool matches = ((words.codes[i] & query.knownMask) == query.knownValue)
+            && ((letters & query.excluded) == 0)
+            && ((letters & query.required) == query.required);
+        out[count] = static_cast<std::uint32_t>(i);
+        count += matches;
+    }
+    return count;
+}
+
+std::size_t filter_scalar(const PackedView& words, const KernelQuery& query, std::uint32_t* out)
+{
+    return filter_range_scalar(words, query, 0, out);
+}
+
+#ifdef HAVE_X86_KERNELS
+
+// Append the indices of the set bits of a lane mask.
+inline std::size_t emit_matches(unsigned int bits, const std::size_t base, std::uint32_t* out)
+{
+    std::size_t count = 0;
+    while (bits != 0) {
+        out[count++] = static_cast<std::uint32_t>(base + __builtin_ctz(bits));
+        bits &= bits - 1;
+    }
+    return count;
+}
+
+__attribute__((target("sse2")))
+std::size_t filter_sse2(const PackedView& words, const KernelQuery& query, std::uint32_t* out)
+{
+    const __m128i knownMask = _mm_set1_epi32(static_cast<int>(query.knownMask));
+    const __m128i knownValue = _mm_set1_epi32(static_cast<int>(query.knownValue));
+    const __m128i excluded = _mm_set1_epi32(static_cast<int>(query.excluded));
+    const __m128i required = _mm_set1_epi32(static_cast<int>(query.required));
+    const __m128i zero = _mm_setzero_si128();
+
+    std::size_t count = 0;
+    std::size_t i = 0;
+    const std::size_t n = words.size();
+    for (; i + 4 <= n; i += 4) {
+        const __m128i codes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&words.codes[i]));
+        const __m128i letters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&words.letters[i]));
+        const __m128i known = _mm_cmpeq_epi32(_mm_and_si128(codes, knownMask), knownValue);
+        const __m128i notExcluded = _mm_cmpeq_epi32(_mm_and_si128(letters, excluded), zero);
+        const __m128i hasRequired = _mm_cmpeq_epi32(_mm_and_si128(letters, required), required);
+        const __m128i match = _mm_and_si128(known, _mm_and_si128(notExcluded, hasRequired));
+        count += emit_matches(_mm_movemask_ps(_mm_castsi128_ps(match)), i, out + count);
+    }
+    return count + filter_range_scalar(words, query, i, out + count);
+}
+
+__attribute__((target("avx2")))
+std::size_t filter_avx2(const PackedView& words, const KernelQuery& query, std::uint32_t* out)
+{
+    const __m256i knownMask = _mm256_set1_epi32(static_cast<int>(query.knownMask));
+    const __m256i knownValue = _mm256_set1_epi32(static_cast<int>(query.knownValue));
+    const __m256i excluded = _mm256_set1_epi32(static_cast<int>(query.excluded));
+    const __m256i required = _mm256_set1_epi32(static_cast<int>(query.required));
+    const __m256i zero = _mm256_setzero_si256();
+
+    std::size_t count = 0;
+    std::size_t i = 0;
+    const std::size_t n = words.size();
+    for (; i + 8 <= n; i += 8) {
+        const __m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&words.codes[i]));
+        const __m256i letters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&words.letters[i]));
+        const __m256i known = _mm256_cmpeq_epi32(_mm256_and_si256(codes, knownMask), knownValue);
+        const __m256i notExcluded = _mm256_cmpeq_epi32(_mm256_and_si256(letters, excluded), zero);
+        const __m256i hasRequired = _mm256_cmpeq_epi32(_mm256_and_si256(letters, required), required);
+        const __m256i match = _mm256_and_si256(known, _mm256_and_si256(notExcluded, hasRequired));
+        count += emit_matches(_mm256_movemask_ps(_mm256_castsi256_ps(match)), i, out + count);
+    }
+    return count + filter_range_scalar(words, query, i, out + count);
+}
+
+__attribute__((target("avx512f")))
+std::size_t filter_avx512(const PackedView& words, const KernelQuery& query, std::uint32_t* out)
+{
+    const __m512i knownMask = _mm512_set1_epi32(static_cast<int>(query.knownMask));
+    const __m512i knownValue = _mm512_set1_epi32(static_cast<int>(query.knownValue));
+    const __m512i excluded = _mm512_set1_epi32(static_cast<int>(query.excluded));
+    const __m512i required = _mm512_set1_epi32(static_cast<int>(query.required));
+    const __m512i step = _mm512_set1_epi32(16);
+    __m512i indices = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    std::size_t count = 0;
+    std::size_t i = 0;
+    const std::size_t n = words.size();
+    for (; i + 16 <= n; i += 16) {
+        const __m512i codes = _mm512_loadu_si512(&words.codes[i]);
+        const __m512i letters = _mm512_loadu_si512(&words.letters[i]);
+        __mmask16 match = _mm512_cmpeq_epi32_mask(_mm512_and_si512(codes, knownMask), knownValue);
+        match = _mm512_mask_testn_epi32_mask(match, letters, excluded);
+        match = _mm512_mask_cmpeq_epi32_mask(match, _mm512_and_si512(letters, required), required);
+        _mm512_mask_compressstoreu_epi32(out + count, match, indices);
+        count += __builtin_popcount(match);
+        indices = _mm512_add_epi32(indices, step);
+    }
+    return count + filter_range_scalar(words, query, i, out + count);
+}
+
+#endif // HAVE_X86_KERNELS
+
+struct KernelEntry {
+    FilterKernelInfo info;
+    bool (*supported)();
+};
+
+const KernelEntry KERNELS[] = {
+#ifdef HAVE_X86_KERNELS
+    {{"avx512", filter_avx512}, [] { return __builtin_cpu_supports("avx512f") != 0; }},
+    {{"avx2", filter_avx2}, [] { return __builtin_cpu_supports("avx2") != 0; }},
+    {{"sse2", filter_sse2}, [] { return __builtin_cpu_supports("sse2") != 0; }},
+#endif
+    {{"scalar", filter_scalar}, [] { return true; }},
+};
+
+} // namespace
+
+FilterKernelInfo select_filter_kernel()
+{
+    for (const KernelEntry& entry : KERNELS) {
+        if (entry.supported()) {
+            return entry.info;
+        }
+    }
+    return {"scalar", filter_scalar};
+}
+
+bool find_filter_kernel(std::string_view name, FilterKernelInfo& info)
+{
+    for (const KernelEntry& entry : KERNELS) {
+        if ((name == entry.info.name) && entry.supported()) {
+            info = entry.info;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace set_solver
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "packed_words.hpp"
+
+namespace set_solver {
+
+// A -known/-exclude/-require query in packed form. A word matches if
+//   (code & knownMask) == knownValue
+//   (letters & excluded) == 0
+//   (letters & required) == required
+struct KernelQuery {
+    std::uint32_t knownMask = 0;
+    std::uint32_t knownValue = 0;
+    std::uint32_t excluded = 0;
+    std::uint32_t required = 0;
+};
+
+// Writes the indices (relative to the view) of all matching words to out,
+// in order, and returns how many there were. out must have room for
+// words.size() entries.
+using FilterKernel = std::size_t (*)(const PackedView& words, const KernelQuery& query, std::uint32_t* out);
+
+struct FilterKernelInfo {
+    const char* name;
+    FilterKernel run;
+};
+
+// The widest kernel the CPU supports (AVX-512, AVX2, SSE2, then scalar).
+FilterKernelInfo select_filter_kernel();
+
+// Look up a kernel by name; returns false if it is unknown or unsupported.
+bool find_filter_kernel(std::string_view name, FilterKernelInfo& info);
+
+} // namespace set_solver
@@ -0,0 +1,95 @@
+#include "length_filter.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace set_solver {
+
+namespace {
+
+// Bit of each lowercase letter, 0 for any other byte.
+constexpr std::array<std::uint32_t, 256> make_letter_bits()
+{
+    std::array<std::uint32_t, 256> bits{};
+    for (char c = 'a'; c <= 'z'; c++) {
+        bits[static_cast<unsigned char>(c)] = 1u << (c - 'a');
+    }
+    return bits;
+}
+
+constexpr std::array<std::uint32_t, 256> LETTER_BITS_OF = make_letter_bits();
+
+// The known letters of a word of N letters, tested 8 at a time:
+// a word matches if (chunk & mask) == value for each of its 8-byte chunks.
+template <std::size_t N>
+struct KnownChunks {
+    static constexpr std::size_t COUNT = (N + 7) / 8;
+    std::array<std::uint64_t, COUNT> mask{};
+    std::array<std::uint64_t, COUNT> value{};
+};
+
+template <std::size_t N>
+KnownChunks<N> make_known_chunks(const LetterQuery& query)
+{
+    std::array<char, KnownChunks<N>::COUNT * 8> letters{};
+    std::array<char, KnownChunks<N>::COUNT * 8> positions{};
+    for (std::size_t i = 0; i < N; i++) {
+        letters[i] = query.known[i];
+        positions[i] = (query.known[i] != 0) ? '\xff' : '\0';
+    }
+    KnownChunks<N> chunks;
+    std::memcpy(chunks.value.data(), letters.data(), letters.size());
+    std::memcpy(chunks.mask.data(), positions.data(), positions.size());
+    return chunks;
+}
+
+// One word against the query. The folds over the letters (I) and the
+// 8-byte chunks (K) give every length straight-line code.
+template <std::size_t N, std::size_t... I, std::size_t... K>
+inline bool matches_word(const std::array<char, N>& word, const KnownChunks<N>& known,
+        const std::uint32_t excluded, const std::uint32_t required,
+        std::index_sequence<I...>, std::index_sequence<K...>)
+{
+    std::array<std::uint64_t, KnownChunks<N>::COUNT> chunks{};
+    std::memcpy(chunks.data(), word.data(), N);
+    const std::uint64_t knownMismatch = (((chunks[K] & known.mask[K]) ^ known.value[K]) | ...);
+    const std::uint32_t letters = (LETTER_BITS_OF[static_cast<unsigned char>(word[I])] | ...);
+    return (knownMismatch == 0) && ((letters & excluded) == 0) && ((letters & required) == required);
+}
+
+template <std::size_t N>
+std::size_t filter_length(const WordTable& words, const LetterQuery& query, std::uint32_t* out)
+{
+    const KnownChunks<N> known = make_known_chunks<N>(query);
+
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < words.count; w++) {
+        std::array<char, N> word;
+        std::memcpy(word.data(), words.data + (w * N), N);
+        out[count] = static_cast<std::uint32_t>(w);
+        count += matches_word(word, known, query.excluded, query.required,
+            std::make_index_sequence<N>(), std::make_index_sequence<KnownChunks<N>::COUNT>());
+    }
+    return count;
+}
+
+template <std::size_t... L>
+constexpr std::array<LengthFilter, sizeof...(L)> make_length_filters(std::index_sequence<L...>)
+{
+    return {filter_length<MIN_WORD_LENGTH + L>...};
+}
+
+// filter_length<N> for every N in MIN_WORD_LENGTH..MAX_WORD_LENGTH.
+constexpr auto LENGTH_FILTERS = make_length_filters(std::make_index_sequence<MAX_WORD_LENGTH - MIN_WORD_LENGTH + 1>());
+
+} // namespace
+
+LengthFilter select_length_filter(const std::size_t length)
+{
+    if ((length < MIN_WORD_LENGTH) || (length > MAX_WORD_LENGTH)) {
+        return nullptr;
+    }
+    return LENGTH_FILTERS[length - MIN_WORD_LENGTH];
+}
+
+} // namespace set_solver
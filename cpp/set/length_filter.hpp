@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "word_index.hpp"
+
+namespace set_solver {
+
+// A -exclude/-require/-known query for words of any indexed length:
+// known[i] is the letter at position i, or 0 if it is unknown.
+struct LetterQuery {
+    std::array<char, MAX_WORD_LENGTH> known{};
+    std::uint32_t excluded = 0;
+    std::uint32_t required = 0;
+};
+
+// Writes the indices of all matching words of the table to out, in order,
+// and returns how many there were. out must have room for words.count entries.
+using LengthFilter = std::size_t (*)(const WordTable& words, const LetterQuery& query, std::uint32_t* out);
+
+// The filter compiled for words of exactly `length` letters (every check
+// unrolled over the positions), or nullptr outside MIN_WORD_LENGTH..MAX_WORD_LENGTH.
+LengthFilter select_length_filter(std::size_t length);
+
+} // namespace set_solver
@@ -1,61 +1,72 @@
 #include <algorithm>
-#include <array>
-#include <bitset>
 #include <cctype>
-#include <fstream>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
-#include <regex>
-#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-constexpr std::size_t WORDLE_WORD_LEN {5};
+#include "args.hpp"
+#include "batch.hpp"
+#include "benchmark.hpp"
+#include "decision_tree.hpp"
+#include "multi_board.hpp"
+#include "query.hpp"
+#include "query_server.hpp"
+#include "simulate.hpp"
+#include "thread_pool.hpp"
+#include "word_index.hpp"
 
-std::string get_arg_param(const std::vector<std::string>& args, std::string_view expected_arg)
-{
-    auto itr = std::find(args.begin(), args.end(), expected_arg);
-    if (itr == args.end()) {
-        return "";
-    }
-    itr++;
-    if (itr == args.end()) {
-        return "";
-    }
-    std::string param = *itr;
-    if (param.at(0) != '-') {
-        return param;
-    }
-    return "";
-}
+using namespace set_solver;
+
+namespace {
 
-std::vector<std::string> split(const std::string& s, const char delim)
+// A whole decimal number, without sign or trailing characters.
+bool parse_number(const std::string& param, std::size_t& value)
 {
-    std::vector<std::string> result;
-    std::stringstream ss(s);
-    std::string token;
-    while (getline(ss, token, delim)) {
-        result.push_back(token);
+    if (param.empty() || !std::all_of(param.begin(), param.end(), [](const unsigned char c) { return std::isdigit(c); })) {
+        return false;
     }
-    return result;
+    errno = 0;
+    value = std::strtoul(param.c_str(), nullptr, 10);
+    return errno == 0;
 }
 
-std::bitset<26> get_letters_from_param(const std::string& param)
+// The hidden answers of simulate and build-tree modes: by default every
+// word, else those of the list at answerPath, which must all be in the
+// dictionary. Words that differ only in case are one answer.
+bool load_answers(const Dictionary& dictionary, const std::string& answerPath, const std::size_t numThreads,
+        std::vector<std::uint32_t>& answers)
 {
-    std::bitset<26> letter_set{0};
-    std::vector<std::string> letters = split(param, ',');
-    for (const std::string& letter : letters) {
-        if (letter.length() != 1) {
-            continue;
-        }
-        const char c = letter.at(0);
-        if (std::isalpha(c)) {
-            const std::size_t pos = c - 'a';
-            letter_set.set(pos);
+    answers.clear();
+    if (answerPath.empty()) {
+        answers = distinct_words(dictionary.packed());
+        return true;
+    }
+    Dictionary answerList;
+    if (!answerList.load(answerPath, numThreads, std::cerr)) {
+        return false;
+    }
+    std::unordered_map<std::uint32_t, std::uint32_t> wordIndices;
+    for (std::size_t w = 0; w < dictionary.packed().size(); w++) {
+        wordIndices.emplace(dictionary.packed().codes[w], static_cast<std::uint32_t>(w));
+    }
+    for (const std::uint32_t a : distinct_words(answerList.packed())) {
+        const auto found = wordIndices.find(answerList.packed().codes[a]);
+        if (found == wordIndices.end()) {
+            std::cerr << "Error: The answer \"" << answerList.words().word(a) << "\" is not in the word list.\n";
+            return false;
         }
+        answers.push_back(found->second);
     }
-    return letter_set;
+    return true;
 }
 
+} // namespace
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -68,117 +79,216 @@ int main(int argc, char** argv)
     // -----------------------------
     const std::vector<std::string> args(argv + 1, argv + argc);
 
-    // Path to text file containing a list of words.
-    const std::string wordFilePathParam = get_arg_param(args, "-list");
-    const std::string wordFilePath = wordFilePathParam != "" ? wordFilePathParam : "../../wordlewords.txt";
+    // Time each stage on a fixed corpus of queries (see make bench).
+    if (args.front() == "bench") {
+        return run_benchmark(args, bench_word_list, std::cout, std::cerr);
+    }
 
-    // List of letters known to not be in the word.
-    // Separate multiple with a comma: -exclude m,s,e
-    const std::string excludeArg = get_arg_param(args, "-exclude");
+    // Precompile a word list: wordle_solver build-index [-list words.txt] [-o words.txt.idx]
+    const bool buildIndex = args.front() == "build-index";
 
-    // List of letters known to be in the word but whose positions are unknown.
-    // Separate multiple with a comma: -require m,s,e
-    const std::string requireArg = get_arg_param(args, "-require");
+    // Precompute every guess/answer feedback pattern:
+    // wordle_solver build-feedback-table [-list words.txt] [-guesses g.txt] [-answers a.txt] [-o table]
+    const bool buildFeedbackTable = args.front() == "build-feedback-table";
 
-    // List of known positions and letters.
-    // Separate multiple with a comma: -known 1m,2o,3u
-    const std::string knownArg = get_arg_param(args, "-known");
+    // Play every word as the hidden answer and report how many guesses the
+    // built-in strategy needed: wordle_solver simulate [-list words.txt] [-answers a.txt]
+    const bool simulate = args.front() == "simulate";
 
-    if (excludeArg.empty() && requireArg.empty() && knownArg.empty()) {
-        std::cerr << "Error: No valid parameters were found for any of the options.\n";
-        return EXIT_FAILURE;
-    }
+    // Precompute the whole strategy as a tree of guesses keyed by feedback:
+    // wordle_solver build-tree [-list words.txt] [-answers a.txt] [-depth D] [-width W] [-o words.txt.tree]
+    const bool buildTree = args.front() == "build-tree";
 
-    // ----------------------------------
-    // GET EXCLUDED AND REQUIRED LETTERS
-    // ----------------------------------
-    // Use sets to prevent any letters from appearing more than once
-    const std::bitset<26> excludedLetterSet = get_letters_from_param(excludeArg);
-    if (excludedLetterSet.count() >= 26) {
-        std::cerr << "Error: All letters of the alphabet have been excluded.\n";
-        return EXIT_FAILURE;
+    // Path to text file containing a list of words. Queries without one use
+    // the bundled list compiled into the binary; the build modes read it.
+    const std::string wordFilePathParam = get_arg_param(args, "-list");
+    const std::string wordFilePath = wordFilePathParam != "" ? wordFilePathParam : BUNDLED_WORD_LIST;
+
+    // Number of threads parsing a large word list, of clients the socket
+    // server answers concurrently, or of threads sharing the queries of a batch.
+    const std::string threadsParam = get_arg_param(args, "-threads");
+    std::size_t numThreads = default_thread_count();
+    if (!threadsParam.empty()) {
+        numThreads = std::strtoul(threadsParam.c_str(), nullptr, 10);
+        if (numThreads == 0) {
+            std::cerr << "Error: -threads must be a positive number.\n";
+            return EXIT_FAILURE;
+        }
     }
 
-    const std::bitset<26> requiredLetterSet = get_letters_from_param(requireArg);
-    if (requiredLetterSet.count() > WORDLE_WORD_LEN) {
-        std::cerr << "Error: More letters are required than are in the word.\n";
-        return EXIT_FAILURE;
+    if (buildIndex) {
+        const std::string indexPathParam = get_arg_param(args, "-o");
+        const std::string indexPath = indexPathParam != "" ? indexPathParam : get_index_path(wordFilePath);
+        if (!build_word_index(wordFilePath, indexPath, numThreads, std::cerr)) {
+            return EXIT_FAILURE;
+        }
+        std::cout << "Wrote \"" << indexPath << "\".\n";
+        return EXIT_SUCCESS;
     }
 
-    if ((excludedLetterSet & requiredLetterSet) != 0) {
-        std::cerr << "Error: The set of excluded letters has one or more letters in common with the set of required letters.\n";
-        return EXIT_FAILURE;
+    // Apply guesses with row lookups into a table from build-feedback-table
+    // (its answers must be the word list): --table=words.txt.fbt
+    const std::string tablePath = get_flag_value(args, "--table");
+
+    // Keep the dictionary loaded and answer queries line by line,
+    // on stdin/stdout (--serve) or on a Unix domain socket (--serve=path).
+    const bool serveStdio = std::find(args.begin(), args.end(), "--serve") != args.end();
+    const std::string socketPath = get_flag_value(args, "--serve");
+
+    if (buildFeedbackTable) {
+        // By default both the guesses and the answers are the whole word list.
+        const std::string guessPathParam = get_arg_param(args, "-guesses");
+        const std::string answerPathParam = get_arg_param(args, "-answers");
+        const std::string answerPath = answerPathParam != "" ? answerPathParam : wordFilePath;
+        const std::string outputParam = get_arg_param(args, "-o");
+        const std::string outputPath = outputParam != "" ? outputParam : get_feedback_table_path(answerPath);
+        Dictionary guesses;
+        Dictionary answers;
+        if (!guesses.load(guessPathParam != "" ? guessPathParam : wordFilePath, numThreads, std::cerr)
+                || !answers.load(answerPath, numThreads, std::cerr)) {
+            return EXIT_FAILURE;
+        }
+        if (!build_feedback_table(guesses.packed(), answers.packed(), outputPath, numThreads, std::cerr)) {
+            return EXIT_FAILURE;
+        }
+        std::cout << "Wrote \"" << outputPath << "\" (" << guesses.packed().size() << " guesses x "
+                  << answers.packed().size() << " answers).\n";
+        return EXIT_SUCCESS;
     }
 
-    // --------------------
-    // GET KNOWN POSITIONS
-    // --------------------
-    std::vector<std::string> knownArgs = split(knownArg, ',');
-    std::array<char, WORDLE_WORD_LEN> knownPositions;
-    knownPositions.fill('*');
+    if (simulate || buildTree) {
+        // Strategy: --score=entropy (default) or --score=remaining, as for --suggest.
+        const std::string scoreName = get_flag_value(args, "--score");
+        GuessScore score = GuessScore::Entropy;
+        if (!scoreName.empty() && !parse_score(scoreName, score)) {
+            std::cerr << "Error: Unknown score \"" << scoreName << "\".\n";
+            return EXIT_FAILURE;
+        }
+        // List every game's guesses.
+        const bool verbose = std::find(args.begin(), args.end(), "--verbose") != args.end();
+
+        Dictionary dictionary;
+        if (!dictionary.load(wordFilePathParam, numThreads, std::cerr)) {
+            return EXIT_FAILURE;
+        }
+
+        // Hidden answers: by default every word, else those of -answers.
+        std::vector<std::uint32_t> answers;
+        const std::string answerPath = get_arg_param(args, "-answers");
+        if (!load_answers(dictionary, answerPath, numThreads, answers)) {
+            return EXIT_FAILURE;
+        }
+        if (simulate) {
+            return run_simulation(dictionary, answers, score, numThreads, verbose, std::cout, std::cerr);
+        }
 
-    for (const std::string& arg : knownArgs) {
-        if (arg.length() != 2) {
-            continue;
+        // Each node tries the best -width guesses (default 4), searching the
+        // nodes below them -depth levels less deep (default 1); -depth 0
+        // plays the simulate strategy.
+        const bool hasWidth = std::find(args.begin(), args.end(), "-width") != args.end();
+        const bool hasDepth = std::find(args.begin(), args.end(), "-depth") != args.end();
+        std::size_t width = 4;
+        std::size_t depth = 1;
+        if (hasWidth && (!parse_number(get_arg_param(args, "-width"), width) || (width == 0))) {
+            std::cerr << "Error: -width must be a positive number.\n";
+            return EXIT_FAILURE;
         }
-        const char position = arg.front();
-        if (!std::isdigit(position) || (position < '1') || (position > '5')) {
-            continue;
+        if (hasDepth && !parse_number(get_arg_param(args, "-depth"), depth)) {
+            std::cerr << "Error: -depth must be a number.\n";
+            return EXIT_FAILURE;
         }
-        const char letter = arg.at(1);
-        if (!std::isalpha(letter)) {
-            continue;
+        const std::string outputParam = get_arg_param(args, "-o");
+        const std::string treePath =
+            outputParam != "" ? outputParam : get_decision_tree_path(answerPath != "" ? answerPath : wordFilePath);
+        const auto start = std::chrono::steady_clock::now();
+        DecisionTreeHeader header;
+        if (!build_decision_tree(dictionary.packed(), answers, score, width, depth, numThreads, treePath, header,
+                std::cerr)) {
+            return EXIT_FAILURE;
         }
-        const std::size_t i = (position - '0') - 1;
-        knownPositions.at(i) = letter;
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Wrote \"" << treePath << "\" (" << header.numNodes << " nodes, "
+                  << header.nodeOffset + (header.numNodes * sizeof(DecisionNode)) << " bytes).\n";
+        std::cout << "Mean guesses: " << static_cast<double>(header.totalGuesses) / header.numAnswers
+                  << ", worst case: " << header.maxGuesses << " (" << header.numAnswers << " answers).\n";
+        std::cerr << "Built in " << seconds << " s (" << numThreads << " threads)\n";
+        return EXIT_SUCCESS;
     }
 
-    // ---------------------------------
-    // APPLY ARGUMENTS TO WORDS IN FILE
-    // ---------------------------------
-    std::ifstream wordFile;
-    wordFile.open(wordFilePath);
-    if (!wordFile.is_open()) {
-        std::cerr << "Error: Unable to open the list of words.\n";
-        return EXIT_FAILURE;
+    // Play from a tree of build-tree: --tree=words.txt.tree with the -guess
+    // history prints the next guess, walking the mapped tree without
+    // loading the word list.
+    const std::string decisionTreePath = get_flag_value(args, "--tree");
+    if (!decisionTreePath.empty()) {
+        return run_tree_lookup(decisionTreePath, args, std::cout, std::cerr);
     }
 
-    std::string line;
-    while (std::getline(wordFile, line)) {
-        std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-        if (line.length() != WORDLE_WORD_LEN) {
-            continue;
+    // Run every query of a file (one per line) against one load of the
+    // word list: --batch queries.txt, with --count to print only counts.
+    const std::string batchPath = get_arg_param(args, "--batch");
+    const bool countOnly = std::find(args.begin(), args.end(), "--count") != args.end();
+
+    if (!batchPath.empty()) {
+        Dictionary dictionary;
+        if (!dictionary.load(wordFilePathParam, numThreads, std::cerr)
+                || (!tablePath.empty() && !dictionary.load_feedback_table(tablePath, std::cerr))) {
+            return EXIT_FAILURE;
         }
+        return run_batch(batchPath, dictionary, countOnly, numThreads, std::cout, std::cerr);
+    }
 
-        bool is_valid_word = true;
-        std::size_t numRequiredLetters = 0;
-        for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
-            const char currentLetter = line.at(i);
-            if (!std::isalpha(currentLetter)) {
-                is_valid_word = false;
-                break;
-            }
-            const char knownLetter = knownPositions.at(i);
-            if ((knownLetter != '*') && (currentLetter != knownLetter)) {
-                is_valid_word = false;
-                break;
-            }
-            const std::size_t currentPos = currentLetter - 'a';
-            if (excludedLetterSet.test(currentPos)) {
-                is_valid_word = false;
-                break;
-            }
-            if (requiredLetterSet.test(currentPos)) {
-                numRequiredLetters++;
-            }
+    // Quordle/Octordle: -board crane:bybbg,... once per board, all filtered
+    // in one pass over the words.
+    if (!get_arg_params(args, "-board").empty()) {
+        Dictionary dictionary;
+        if (!dictionary.load(wordFilePathParam, numThreads, std::cerr)) {
+            return EXIT_FAILURE;
         }
+        return run_multi_board(args, dictionary, std::cout, std::cerr);
+    }
 
-        if (is_valid_word && (numRequiredLetters == requiredLetterSet.count())) {
-            std::cout << line << "\n";
+    if (serveStdio || !socketPath.empty()) {
+        Dictionary dictionary;
+        if (!dictionary.load(wordFilePathParam, numThreads, std::cerr)
+                || (!tablePath.empty() && !dictionary.load_feedback_table(tablePath, std::cerr))) {
+            return EXIT_FAILURE;
         }
+        return serve_queries(socketPath, numThreads, [&dictionary] { return make_session_handler(dictionary); });
     }
 
-    wordFile.close();
+    // --------------
+    // RUN ONE QUERY
+    // --------------
+    // Report where the time went as JSON on stderr.
+    const bool showStats = std::find(args.begin(), args.end(), "--stats") != args.end();
+
+    const auto compileStart = std::chrono::steady_clock::now();
+    Query query;
+    if (!parse_query(args, query, std::cerr)) {
+        return EXIT_FAILURE;
+    }
+    QueryStats stats;
+    stats.compileMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - compileStart).count();
+    if ((query.length != WORDLE_WORD_LEN) && (wordFilePathParam == "")) {
+        std::cerr << "Error: Must provide an alternate word list if using a word length other than 5.\n";
+        return EXIT_FAILURE;
+    }
+
+    Dictionary dictionary;
+    if (!dictionary.load(wordFilePathParam, numThreads, std::cerr)
+            || (!tablePath.empty() && !dictionary.load_feedback_table(tablePath, std::cerr))) {
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<std::uint32_t> matches = find_matches(dictionary, query, showStats ? &stats : nullptr, std::cerr);
+    const auto outputStart = std::chrono::steady_clock::now();
+    print_results(dictionary, query, matches, std::cout, std::cerr);
+
+    if (showStats) {
+        std::cout.flush();
+        stats.outputMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - outputStart).count();
+        add_load_stats(dictionary.load_stats(), dictionary.word_index(), query.length, stats);
+        write_stats_json(stats, std::cerr);
+    }
     return EXIT_SUCCESS;
 }
-
@@ -0,0 +1,153 @@
+#include "multi_board.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+#include "args.hpp"
+#include "feedback.hpp"
+#include "parallel.hpp"
+
+namespace set_solver {
+
+namespace {
+
+// Words per tile: codes and letter masks of one tile fit in L1 cache.
+constexpr std::size_t TILE_WORDS = 2048;
+// Lists shorter than this per thread are filtered on one thread.
+constexpr std::size_t MIN_WORDS_PER_THREAD = 1 << 16;
+
+struct Board {
+    Query query;
+    KernelQuery filter;
+    // False if the board's constraints contradict each other.
+    bool possible = true;
+    // One of the board's guesses was all green.
+    bool solved = false;
+    std::vector<std::uint32_t> matches;
+};
+
+// Append the matches of every board among words [begin, end) to
+// matches[board], running all the boards on a tile before the next one.
+void filter_boards(const PackedView& words, const LetterCounts* counts, const std::vector<Board>& boards,
+        const std::size_t begin, const std::size_t end, std::vector<std::vector<std::uint32_t>>& matches)
+{
+    std::vector<std::uint32_t> tileMatches(TILE_WORDS);
+    for (std::size_t first = begin; first < end; first += TILE_WORDS) {
+        const PackedView tile = words.slice(first, std::min(TILE_WORDS, end - first));
+        for (std::size_t b = 0; b < boards.size(); b++) {
+            const Board& board = boards[b];
+            if (!board.possible) {
+                continue;
+            }
+            const std::size_t numMatches = board.query.kernel.run(tile, board.filter, tileMatches.data());
+            for (std::size_t i = 0; i < numMatches; i++) {
+                const std::size_t w = first + tileMatches[i];
+                if ((!board.query.counts.bounded() || board.query.counts.matches(counts[w]))
+                        && (board.query.guesses.empty() || satisfies_guesses(board.query, tile.codes[tileMatches[i]]))) {
+                    matches[b].push_back(static_cast<std::uint32_t>(w));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int run_multi_board(const std::vector<std::string>& args, const Dictionary& dictionary,
+        std::ostream& out, std::ostream& err)
+{
+    // Every option but the -board values applies to all the boards.
+    std::vector<std::string> sharedArgs;
+    for (std::size_t i = 0; i < args.size(); i++) {
+        if ((args[i] == "-board") && (i + 1 < args.size())) {
+            i++;
+            continue;
+        }
+        sharedArgs.push_back(args[i]);
+    }
+    const bool countOnly = std::find(args.begin(), args.end(), "--count") != args.end();
+
+    const std::vector<std::string> boardParams = get_arg_params(args, "-board");
+    if (boardParams.empty()) {
+        err << "Error: Expected at least one -board, e.g. -board crane:bybbg.\n";
+        return EXIT_FAILURE;
+    }
+    std::vector<Board> boards(boardParams.size());
+    for (std::size_t b = 0; b < boards.size(); b++) {
+        Board& board = boards[b];
+        std::vector<std::string> boardArgs = sharedArgs;
+        for (const std::string& guessParam : split(boardParams[b], ',')) {
+            boardArgs.push_back("-guess");
+            boardArgs.push_back(guessParam);
+        }
+        if (!parse_query(boardArgs, board.query, err)) {
+            return EXIT_FAILURE;
+        }
+        if (board.query.length != WORDLE_WORD_LEN) {
+            err << "Error: Multi-board mode only supports " << WORDLE_WORD_LEN << "-letter words.\n";
+            return EXIT_FAILURE;
+        }
+        board.possible = first_pass_filter(board.query, board.filter);
+        board.solved = std::find(board.query.guessPatterns.begin(), board.query.guessPatterns.end(), ALL_GREEN)
+            != board.query.guessPatterns.end();
+    }
+    const Query& shared = boards.front().query;
+    if ((shared.rankCount > 0) || (shared.coverCount > 0)) {
+        err << "Error: --rank, --top and --cover are not supported in multi-board mode.\n";
+        return EXIT_FAILURE;
+    }
+
+    // Large lists are cut into ranges filtered on their own threads, each
+    // with all the boards; the ranges' matches are concatenated in order.
+    const PackedView words = dictionary.packed();
+    // The letter counts are only built if a board has -count bounds.
+    const bool anyCounts = std::any_of(boards.begin(), boards.end(),
+        [](const Board& board) { return board.query.counts.bounded(); });
+    const LetterCounts* counts = anyCounts ? dictionary.letter_counts() : nullptr;
+    const std::size_t numRanges =
+        std::max<std::size_t>(1, std::min(shared.numThreads, words.size() / MIN_WORDS_PER_THREAD));
+    std::vector<std::vector<std::vector<std::uint32_t>>> rangeMatches(
+        numRanges, std::vector<std::vector<std::uint32_t>>(boards.size()));
+    parallel_for(numRanges, numRanges, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t r = begin; r < end; r++) {
+            filter_boards(words, counts, boards, (words.size() * r) / numRanges,
+                (words.size() * (r + 1)) / numRanges, rangeMatches[r]);
+        }
+    });
+    for (std::size_t b = 0; b < boards.size(); b++) {
+        for (const std::vector<std::vector<std::uint32_t>>& range : rangeMatches) {
+            boards[b].matches.insert(boards[b].matches.end(), range[b].begin(), range[b].end());
+        }
+    }
+
+    const WordTable& table = dictionary.words();
+    if (shared.suggestCount > 0) {
+        std::vector<std::vector<std::uint32_t>> unsolved;
+        for (Board& board : boards) {
+            if (!board.solved) {
+                unsolved.push_back(std::move(board.matches));
+            }
+        }
+        for (const Suggestion& suggestion :
+                suggest_guesses(words, unsolved, shared.score, shared.suggestCount, shared.numThreads)) {
+            out << table.word(suggestion.word) << " " << suggestion.score << "\n";
+        }
+        return EXIT_SUCCESS;
+    }
+
+    for (std::size_t b = 0; b < boards.size(); b++) {
+        if (countOnly) {
+            out << (b + 1) << " " << boards[b].matches.size() << "\n";
+            continue;
+        }
+        out << "# " << (b + 1) << " " << boards[b].matches.size() << "\n";
+        for (const std::uint32_t w : boards[b].matches) {
+            out << table.word(w) << "\n";
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace set_solver
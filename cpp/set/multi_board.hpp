@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "query.hpp"
+
+namespace set_solver {
+
+// Multi-board mode (Quordle, Octordle): one -board per board, each with that
+// board's guesses and feedback, e.g.
+//   -board crane:bybbg,tolus:ygbbb -board crane:bbgbb,tolus:bbbbg ...
+// -exclude, -require, -known and -count apply to every board.
+//
+// All boards are filtered in one pass over the packed words: each tile is
+// tested against every board while it is in cache. The result is one
+//   # <board> <count>
+//   <matches...>
+// block per board (one "<board> <count>" line with --count), or with
+// --suggest N the N best next guesses, each scored once against the
+// candidates of every board not yet solved (no all-green guess).
+int run_multi_board(const std::vector<std::string>& args, const Dictionary& dictionary,
+        std::ostream& out, std::ostream& err);
+
+} // namespace set_solver
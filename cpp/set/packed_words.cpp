@@ -0,0 +1,59 @@
+#include "packed_words.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "parallel.hpp"
+
+namespace set_solver {
+
+namespace {
+
+// Smaller lists are packed on one thread.
+constexpr std::size_t MIN_PACK_WORDS_PER_THREAD = 1 << 16;
+
+} // namespace
+
+PackedWords pack_words(const WordTable& words, const std::size_t numThreads)
+{
+    PackedWords packed;
+    packed.codes.resize(words.count);
+    packed.letters.resize(words.count);
+    const std::size_t usefulThreads = std::max<std::size_t>(1, words.count / MIN_PACK_WORDS_PER_THREAD);
+    parallel_for(words.count, std::min(numThreads, usefulThreads), [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t w = begin; w < end; w++) {
+            const std::string_view word = words.word(w);
+            std::uint32_t letters = 0;
+            for (const char c : word) {
+                letters |= letter_bit(c);
+            }
+            packed.codes[w] = pack_code(word);
+            packed.letters[w] = letters;
+        }
+    });
+    return packed;
+}
+
+std::vector<std::uint32_t> distinct_words(const PackedView& words)
+{
+    std::vector<std::uint32_t> distinct;
+    distinct.reserve(words.size());
+    std::unordered_set<std::uint32_t> seen;
+    for (std::size_t w = 0; w < words.size(); w++) {
+        if (seen.insert(words.codes[w]).second) {
+            distinct.push_back(static_cast<std::uint32_t>(w));
+        }
+    }
+    return distinct;
+}
+
+std::uint32_t pack_code(const std::string_view word)
+{
+    std::uint32_t code = 0;
+    for (std::size_t i = 0; i < word.length(); i++) {
+        code |= static_cast<std::uint32_t>((word[i] | 0x20) - 'a') << (LETTER_BITS * i);
+    }
+    return code;
+}
+
+} // namespace set_solver
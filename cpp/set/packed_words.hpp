@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "word_index.hpp"
+
+namespace set_solver {
+
+constexpr std::size_t WORDLE_WORD_LEN {5};
+
+// Bits used to store one letter ('a' = 0 ... 'z' = 25) in a positional code.
+constexpr unsigned int LETTER_BITS = 5;
+constexpr std::uint32_t LETTER_MASK = (1u << LETTER_BITS) - 1;
+
+// Every word of a table pre-encoded as two 32-bit values, stored as
+// parallel arrays so the filter kernels can load 4, 8 or 16 words at once:
+//  - codes:   letter i in bits [5i, 5i + 5), i.e. a 25-bit code for 5 letters
+//  - letters: bit c set if letter 'a' + c occurs anywhere in the word
+struct PackedView {
+    const std::uint32_t* codes = nullptr;
+    const std::uint32_t* letters = nullptr;
+    std::size_t count = 0;
+
+    std::size_t size() const { return count; }
+
+    // Words [first, first + n) of this view.
+    PackedView slice(const std::size_t first, const std::size_t n) const
+    {
+        return PackedView{codes + first, letters + first, n};
+    }
+};
+
+// Owning storage for a PackedView.
+struct PackedWords {
+    std::vector<std::uint32_t> codes;
+    std::vector<std::uint32_t> letters;
+
+    std::size_t size() const { return codes.size(); }
+    PackedView view() const { return PackedView{codes.data(), letters.data(), codes.size()}; }
+};
+
+// Pack every word of the table, on up to numThreads threads for large tables.
+PackedWords pack_words(const WordTable& words, std::size_t numThreads);
+
+// Indices of the words with distinct codes, in order: the first of each
+// group of words that differ only in case.
+std::vector<std::uint32_t> distinct_words(const PackedView& words);
+
+// Positional code of one word (either case) of at most 6 letters.
+std::uint32_t pack_code(std::string_view word);
+
+inline std::uint32_t letter_bit(const char c)
+{
+    return 1u << (c - 'a');
+}
+
+// Letter ('a' = 0 ... 'z' = 25) at a position of a positional code.
+inline std::uint32_t letter_at(const std::uint32_t code, const std::size_t position)
+{
+    return (code >> (LETTER_BITS * position)) & LETTER_MASK;
+}
+
+} // namespace set_solver
@@ -0,0 +1,97 @@
+#include "posting_index.hpp"
+
+namespace set_solver {
+
+namespace {
+
+constexpr std::size_t NUM_LETTERS = 26;
+constexpr std::size_t BLOCK_BITS = 64;
+
+} // namespace
+
+PostingIndex::PostingIndex(const PackedView& words, const std::size_t length)
+    : numWords(words.size()),
+      numBlocks((words.size() + BLOCK_BITS - 1) / BLOCK_BITS),
+      wordLength(length),
+      positionalBits(length * NUM_LETTERS * numBlocks, 0),
+      presentBits(NUM_LETTERS * numBlocks, 0)
+{
+    for (std::size_t w = 0; w < numWords; w++) {
+        const std::size_t block = w / BLOCK_BITS;
+        const std::uint64_t bit = std::uint64_t{1} << (w % BLOCK_BITS);
+        const std::uint32_t code = words.codes[w];
+        for (std::size_t i = 0; i < wordLength; i++) {
+            const std::size_t letter = (code >> (LETTER_BITS * i)) & LETTER_MASK;
+            positionalBits[(((i * NUM_LETTERS) + letter) * numBlocks) + block] |= bit;
+        }
+        std::uint32_t letters = words.letters[w];
+        while (letters != 0) {
+            const std::size_t letter = __builtin_ctz(letters);
+            presentBits[(letter * numBlocks) + block] |= bit;
+            letters &= letters - 1;
+        }
+    }
+}
+
+const std::uint64_t* PostingIndex::positional(const std::size_t position, const std::size_t letter) const
+{
+    return &positionalBits[((position * NUM_LETTERS) + letter) * numBlocks];
+}
+
+const std::uint64_t* PostingIndex::present(const std::size_t letter) const
+{
+    return &presentBits[letter * numBlocks];
+}
+
+std::size_t PostingIndex::query(const KernelQuery& query, std::vector<std::uint64_t>& matches) const
+{
+    // Gather every posting list the query touches, then combine them in a
+    // single pass so each output block is written exactly once.
+    std::vector<const std::uint64_t*> andLists;
+    std::vector<const std::uint64_t*> andNotLists;
+    for (std::size_t i = 0; i < wordLength; i++) {
+        if (((query.knownMask >> (LETTER_BITS * i)) & LETTER_MASK) != 0) {
+            andLists.push_back(positional(i, (query.knownValue >> (LETTER_BITS * i)) & LETTER_MASK));
+        }
+    }
+    for (std::size_t letter = 0; letter < NUM_LETTERS; letter++) {
+        if ((query.required >> letter) & 1) {
+            andLists.push_back(present(letter));
+        }
+        if ((query.excluded >> letter) & 1) {
+            andNotLists.push_back(present(letter));
+        }
+    }
+
+    matches.assign(numBlocks, ~std::uint64_t{0});
+    if ((numWords % BLOCK_BITS) != 0) {
+        matches.back() = (std::uint64_t{1} << (numWords % BLOCK_BITS)) - 1;
+    }
+
+    std::size_t count = 0;
+    for (std::size_t b = 0; b < numBlocks; b++) {
+        std::uint64_t block = matches[b];
+        for (const std::uint64_t* list : andLists) {
+            block &= list[b];
+        }
+        for (const std::uint64_t* list : andNotLists) {
+            block &= ~list[b];
+        }
+        matches[b] = block;
+        count += __builtin_popcountll(block);
+    }
+    return count;
+}
+
+void collect_matches(const std::vector<std::uint64_t>& bits, std::vector<std::uint32_t>& indices)
+{
+    for (std::size_t b = 0; b < bits.size(); b++) {
+        std::uint64_t block = bits[b];
+        while (block != 0) {
+            indices.push_back(static_cast<std::uint32_t>((b * BLOCK_BITS) + __builtin_ctzll(block)));
+            block &= block - 1;
+        }
+    }
+}
+
+} // namespace set_solver
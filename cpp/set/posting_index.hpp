@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "filter_kernel.hpp"
+#include "packed_words.hpp"
+
+namespace set_solver {
+
+// Inverted index over a packed word table: one bitvector per
+// (position, letter) pair and one per letter present, with bit w of each
+// bitvector describing word w. A query is then a handful of AND/ANDNOT
+// passes over 64-bit blocks instead of a scan over the words.
+class PostingIndex {
+public:
+    PostingIndex(const PackedView& words, std::size_t wordLength);
+
+    // Fill matches with one bit per word and return the number of matches.
+    std::size_t query(const KernelQuery& query, std::vector<std::uint64_t>& matches) const;
+
+    std::size_t size() const { return numWords; }
+
+private:
+    const std::uint64_t* positional(std::size_t position, std::size_t letter) const;
+    const std::uint64_t* present(std::size_t letter) const;
+
+    std::size_t numWords;
+    std::size_t numBlocks;
+    std::size_t wordLength;
+    std::vector<std::uint64_t> positionalBits;
+    std::vector<std::uint64_t> presentBits;
+};
+
+// Append the index of every set bit, in order.
+void collect_matches(const std::vector<std::uint64_t>& bits, std::vector<std::uint32_t>& indices);
+
+} // namespace set_solver
@@ -0,0 +1,744 @@
+#include "query.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+
+#include "args.hpp"
+#include "feedback.hpp"
+#include "letter_rank.hpp"
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+
+namespace set_solver {
+
+namespace {
+
+// Lists shorter than this per thread are filtered on one thread, where
+// starting the others would cost more than the scan (the bundled 16k-word
+// list always is).
+constexpr std::size_t MIN_WORDS_PER_THREAD = 1 << 16;
+// Words per tile when matches go to a caller's buffer: the tile's matches
+// are checked in full and written out before the next tile is filtered.
+constexpr std::size_t TILE_WORDS = 2048;
+
+// --stats: count the words of the query's length rejected by each of the
+// -known, -exclude, -require and -count tests (the first one failed), and
+// return how many passed all four. Run only when asked for, after the
+// timed scan.
+std::size_t count_rejections(const Dictionary& dictionary, const Query& query, QueryStats& stats)
+{
+    std::size_t passed = 0;
+    if (query.length == WORDLE_WORD_LEN) {
+        const PackedView words = dictionary.packed();
+        const KernelQuery& filter = query.filter;
+        for (std::size_t w = 0; w < words.size(); w++) {
+            if ((words.codes[w] & filter.knownMask) != filter.knownValue) {
+                stats.rejectedKnown++;
+            } else if ((words.letters[w] & filter.excluded) != 0) {
+                stats.rejectedExcluded++;
+            } else if ((words.letters[w] & filter.required) != filter.required) {
+                stats.rejectedRequired++;
+            } else if (query.counts.bounded() && !query.counts.matches(dictionary.letter_counts()[w])) {
+                stats.rejectedCount++;
+            } else {
+                passed++;
+            }
+        }
+        return passed;
+    }
+
+    const WordTable words = dictionary.words(query.length);
+    const LetterQuery& letters = query.letters;
+    for (std::size_t w = 0; w < words.count; w++) {
+        const std::string_view word = words.word(w);
+        bool knownMismatch = false;
+        std::uint32_t present = 0;
+        for (std::size_t i = 0; i < word.length(); i++) {
+            knownMismatch |= (letters.known[i] != 0) && (word[i] != letters.known[i]);
+            present |= letter_bit(word[i]);
+        }
+        if (knownMismatch) {
+            stats.rejectedKnown++;
+        } else if ((present & letters.excluded) != 0) {
+            stats.rejectedExcluded++;
+        } else if ((present & letters.required) != letters.required) {
+            stats.rejectedRequired++;
+        } else if (!query.counts.matches(count_letters(word.data(), word.length()))) {
+            stats.rejectedCount++;
+        } else {
+            passed++;
+        }
+    }
+    return passed;
+}
+
+} // namespace
+
+bool Dictionary::load(const std::string& wordFilePath, const std::size_t numThreads, std::ostream& err)
+{
+    const bool loaded = wordFilePath != "" ? load_word_list(wordFilePath, index, numThreads, loadStats, err)
+                                           : load_bundled_word_list(index, numThreads, loadStats, err);
+    if (!loaded) {
+        return false;
+    }
+    const auto packStart = std::chrono::steady_clock::now();
+    wordTable = index.words(WORDLE_WORD_LEN);
+    packedWords = pack_words(wordTable, numThreads);
+    loadStats.parseMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - packStart).count();
+    return true;
+}
+
+const PostingIndex& Dictionary::postings() const
+{
+    std::call_once(postingsBuilt, [this] {
+        postingIndex = std::make_unique<PostingIndex>(packedWords.view(), WORDLE_WORD_LEN);
+    });
+    return *postingIndex;
+}
+
+const LetterCounts* Dictionary::letter_counts() const
+{
+    std::call_once(letterCountsBuilt, [this] { letterCounts = count_letters(wordTable, 1); });
+    return letterCounts.data();
+}
+
+bool Dictionary::load_feedback_table(const std::string& tablePath, std::ostream& err)
+{
+    auto newTable = std::make_unique<FeedbackTable>();
+    if (!newTable->open(tablePath, err)) {
+        return false;
+    }
+    if (newTable->header()->answerHash != hash_words(packed())) {
+        err << "Error: The feedback table \"" << tablePath << "\" was built for a different word list.\n";
+        return false;
+    }
+    table = std::move(newTable);
+    return true;
+}
+
+std::bitset<26> get_letters_from_param(const std::string& param)
+{
+    std::bitset<26> letter_set{0};
+    std::vector<std::string> letters = split(param, ',');
+    for (const std::string& letter : letters) {
+        if (letter.length() != 1) {
+            continue;
+        }
+        const char c = static_cast<char>(std::tolower(letter.at(0)));
+        if (std::isalpha(c)) {
+            const std::size_t pos = c - 'a';
+            letter_set.set(pos);
+        }
+    }
+    return letter_set;
+}
+
+bool parse_query(const std::vector<std::string>& args, Query& query, std::ostream& err)
+{
+    // List of letters known to not be in the word.
+    // Separate multiple with a comma: -exclude m,s,e
+    const std::string excludeArg = get_arg_param(args, "-exclude");
+
+    // List of letters known to be in the word but whose positions are unknown.
+    // Separate multiple with a comma: -require m,s,e
+    const std::string requireArg = get_arg_param(args, "-require");
+
+    // List of known positions and letters.
+    // Separate multiple with a comma: -known 1m,2o,3u
+    const std::string knownArg = get_arg_param(args, "-known");
+
+    // The length of the word to be found: -length 6 (default 5).
+    const std::string lengthParam = get_arg_param(args, "-length");
+
+    // How often letters occur, as bounds: -count e=2,a<=1,s>=1
+    const std::string countArg = get_arg_param(args, "-count");
+
+    // Rearrangements of some letters, '?' for any letter: -anagram crate or
+    // -anagram cra?e. Sets the word length.
+    const std::string anagramArg = get_arg_param(args, "-anagram");
+
+    // A guess and the feedback it got, once per turn: -guess crane:gybbg
+    // (g = green, y = yellow, b = black/gray).
+    query.guessParams = get_arg_params(args, "-guess");
+
+    // How to evaluate the query: scan the packed words with a filter kernel
+    // (--engine=scan, the default) or combine posting lists (--engine=postings).
+    const std::string engineName = get_flag_value(args, "--engine");
+    if (!engineName.empty() && (engineName != "scan") && (engineName != "postings")) {
+        err << "Error: Unknown engine \"" << engineName << "\".\n";
+        return false;
+    }
+    query.usePostings = engineName == "postings";
+
+    // Report the query latency.
+    query.verbose = std::find(args.begin(), args.end(), "--verbose") != args.end();
+
+    // Suggest the N best next guesses: --suggest N, scored by expected
+    // information (--score=entropy, the default) or by the expected number
+    // of remaining candidates (--score=remaining).
+    const std::string suggestParam = get_arg_param(args, "--suggest");
+    query.suggestCount = 0;
+    if (!suggestParam.empty()) {
+        query.suggestCount = std::strtoul(suggestParam.c_str(), nullptr, 10);
+        if (query.suggestCount == 0) {
+            err << "Error: --suggest must be a positive number.\n";
+            return false;
+        }
+    }
+    const std::string scoreName = get_flag_value(args, "--score");
+    query.score = GuessScore::Entropy;
+    if (!scoreName.empty() && !parse_score(scoreName, query.score)) {
+        err << "Error: Unknown score \"" << scoreName << "\".\n";
+        return false;
+    }
+
+    // Order the matches by how common their letters are among the matches,
+    // best first: --rank, or --top K to keep only the best K.
+    const bool rank = std::find(args.begin(), args.end(), "--rank") != args.end();
+    const std::string topParam = get_arg_param(args, "--top");
+    query.rankCount = rank ? SIZE_MAX : 0;
+    if (!topParam.empty()) {
+        query.rankCount = std::strtoul(topParam.c_str(), nullptr, 10);
+        if (query.rankCount == 0) {
+            err << "Error: --top must be a positive number.\n";
+            return false;
+        }
+    }
+    if ((query.rankCount > 0) && (query.suggestCount > 0)) {
+        err << "Error: --rank and --top cannot be combined with --suggest.\n";
+        return false;
+    }
+
+    // The k words that together contain the most letters not yet tested
+    // (excluded, required, known or guessed), as elimination guesses: --cover k
+    const std::string coverParam = get_arg_param(args, "--cover");
+    query.coverCount = 0;
+    if (!coverParam.empty()) {
+        query.coverCount = std::strtoul(coverParam.c_str(), nullptr, 10);
+        if (query.coverCount == 0) {
+            err << "Error: --cover must be a positive number.\n";
+            return false;
+        }
+        if ((query.rankCount > 0) || (query.suggestCount > 0)) {
+            err << "Error: --cover cannot be combined with --rank, --top or --suggest.\n";
+            return false;
+        }
+    }
+
+    // Threads used to score guesses.
+    const std::string threadsParam = get_arg_param(args, "-threads");
+    query.numThreads = default_thread_count();
+    if (!threadsParam.empty()) {
+        query.numThreads = std::strtoul(threadsParam.c_str(), nullptr, 10);
+        if (query.numThreads == 0) {
+            err << "Error: -threads must be a positive number.\n";
+            return false;
+        }
+    }
+
+    // Force a particular filter kernel instead of the fastest supported one.
+    // --kernel=avx512, --kernel=avx2, --kernel=sse2 or --kernel=scalar
+    const std::string kernelName = get_flag_value(args, "--kernel");
+    query.kernel = select_filter_kernel();
+    if (!kernelName.empty() && !find_filter_kernel(kernelName, query.kernel)) {
+        err << "Error: The \"" << kernelName << "\" kernel is unknown or not supported by this CPU.\n";
+        return false;
+    }
+
+    // With --suggest, --rank, --top or --cover alone, every word is a candidate.
+    query.length = WORDLE_WORD_LEN;
+    if (!lengthParam.empty()) {
+        query.length = std::strtoul(lengthParam.c_str(), nullptr, 10);
+        if ((query.length < MIN_WORD_LENGTH) || (query.length > MAX_WORD_LENGTH)) {
+            err << "Error: Word length must be between " << MIN_WORD_LENGTH << " and " << MAX_WORD_LENGTH << ".\n";
+            return false;
+        }
+    }
+    query.counts = CountQuery();
+    std::string countError;
+    if ((!countArg.empty() && !parse_count_query(countArg, query.counts, countError))
+            || (!anagramArg.empty() && !parse_anagram(anagramArg, query.counts, countError))) {
+        err << "Error: " << countError << "\n";
+        return false;
+    }
+    if (!anagramArg.empty()) {
+        if (!lengthParam.empty() && (query.length != anagramArg.length())) {
+            err << "Error: -anagram has " << anagramArg.length() << " letters but -length is " << query.length << ".\n";
+            return false;
+        }
+        query.length = anagramArg.length();
+    }
+    // Guesses, suggestions and posting lists work on the packed 5-letter codes.
+    if ((query.length != WORDLE_WORD_LEN)
+            && (!query.guessParams.empty() || (query.suggestCount > 0) || (query.coverCount > 0) || query.usePostings)) {
+        err << "Error: -guess, --suggest, --cover and --engine=postings only support " << WORDLE_WORD_LEN
+            << "-letter words.\n";
+        return false;
+    }
+
+    if (excludeArg.empty() && requireArg.empty() && knownArg.empty() && countArg.empty() && anagramArg.empty()
+            && query.guessParams.empty() && (query.suggestCount == 0) && (query.rankCount == 0)
+            && (query.coverCount == 0)) {
+        err << "Error: No valid parameters were found for any of the options.\n";
+        return false;
+    }
+
+    // --------------------
+    // COMPILE THE GUESSES
+    // --------------------
+    query.guesses.clear();
+    query.guessCodes.clear();
+    query.guessPatterns.clear();
+    for (const std::string& guessParam : query.guessParams) {
+        std::string guess;
+        std::string feedback;
+        std::string error;
+        Constraints guessConstraints;
+        if (!split_guess_param(guessParam, guess, feedback)) {
+            err << "Error: Expected -guess <word>:<feedback>, e.g. -guess crane:gybbg.\n";
+            return false;
+        }
+        if (!guessConstraints.add_guess(guess, feedback, error)) {
+            err << "Error: " << error << "\n";
+            return false;
+        }
+        std::uint8_t pattern = 0;
+        parse_feedback(feedback, pattern);
+        query.guesses.push_back(guessConstraints);
+        query.guessCodes.push_back(pack_code(guess));
+        // So that a feedback table row matches what guessConstraints does.
+        query.guessPatterns.push_back(canonical_feedback(query.guessCodes.back(), pattern));
+    }
+
+    // ----------------------------------
+    // GET EXCLUDED AND REQUIRED LETTERS
+    // ----------------------------------
+    // Use sets to prevent any letters from appearing more than once
+    const std::bitset<26> excludedLetterSet = get_letters_from_param(excludeArg);
+    if (excludedLetterSet.count() >= 26) {
+        err << "Error: All letters of the alphabet have been excluded.\n";
+        return false;
+    }
+
+    const std::bitset<26> requiredLetterSet = get_letters_from_param(requireArg);
+    if (requiredLetterSet.count() > query.length) {
+        err << "Error: More letters are required than are in the word.\n";
+        return false;
+    }
+
+    if ((excludedLetterSet & requiredLetterSet) != 0) {
+        err << "Error: The set of excluded letters has one or more letters in common with the set of required letters.\n";
+        return false;
+    }
+
+    // --------------------
+    // GET KNOWN POSITIONS
+    // --------------------
+    std::vector<std::string> knownArgs = split(knownArg, ',');
+    std::array<char, MAX_WORD_LENGTH> knownPositions;
+    knownPositions.fill('*');
+
+    for (const std::string& arg : knownArgs) {
+        // A 1-based position (up to two digits) followed by a letter: 3u, 10s
+        const std::size_t numDigits = arg.find_first_not_of("0123456789");
+        if ((numDigits == 0) || (numDigits > 2) || (arg.length() != numDigits + 1)) {
+            continue;
+        }
+        const std::size_t position = std::stoul(arg.substr(0, numDigits));
+        if ((position < 1) || (position > query.length)) {
+            continue;
+        }
+        const char letter = static_cast<char>(std::tolower(arg.back()));
+        if (!std::isalpha(letter)) {
+            continue;
+        }
+        knownPositions.at(position - 1) = letter;
+    }
+
+    query.letters = LetterQuery();
+    query.letters.excluded = static_cast<std::uint32_t>(excludedLetterSet.to_ulong());
+    query.letters.required = static_cast<std::uint32_t>(requiredLetterSet.to_ulong());
+    // Presence is much cheaper to test than counts: let the filter reject
+    // the words missing a letter a count requires, or having one it forbids.
+    query.letters.excluded |= query.counts.excluded_letters();
+    query.letters.required |= query.counts.required_letters();
+    for (std::size_t i = 0; i < query.length; i++) {
+        query.letters.known[i] = knownPositions.at(i) != '*' ? knownPositions.at(i) : '\0';
+    }
+
+    // -----------------------
+    // BUILD THE PACKED QUERY
+    // -----------------------
+    query.filter = KernelQuery();
+    if (query.length != WORDLE_WORD_LEN) {
+        return true;
+    }
+    query.filter.excluded = query.letters.excluded;
+    query.filter.required = query.letters.required;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        const char knownLetter = knownPositions.at(i);
+        if (knownLetter != '*') {
+            query.filter.knownMask |= LETTER_MASK << (LETTER_BITS * i);
+            query.filter.knownValue |= static_cast<std::uint32_t>(knownLetter - 'a') << (LETTER_BITS * i);
+        }
+    }
+    return true;
+}
+
+bool compile_query(const QueryConstraints& constraints, const std::size_t numThreads, Query& query,
+        std::ostream& err)
+{
+    // "moac" -> "m,o,a,c"
+    const auto letter_list = [](const std::string& letters) {
+        std::string list;
+        for (const char c : letters) {
+            list += list.empty() ? "" : ",";
+            list += c;
+        }
+        return list;
+    };
+
+    std::vector<std::string> args = {"-length", std::to_string(constraints.length), "-threads", std::to_string(numThreads)};
+    if (!constraints.exclude.empty()) {
+        args.insert(args.end(), {"-exclude", letter_list(constraints.exclude)});
+    }
+    if (!constraints.require.empty()) {
+        args.insert(args.end(), {"-require", letter_list(constraints.require)});
+    }
+    if (!constraints.known.empty()) {
+        args.insert(args.end(), {"-known", constraints.known});
+    }
+    if (!constraints.count.empty()) {
+        args.insert(args.end(), {"-count", constraints.count});
+    }
+    for (const std::string& guess : constraints.guesses) {
+        args.insert(args.end(), {"-guess", guess});
+    }
+    return parse_query(args, query, err);
+}
+
+bool first_pass_filter(const Query& query, KernelQuery& filter)
+{
+    filter = query.filter;
+    return query.guesses.empty() || combine_queries(filter, query.guesses.front().prefilter());
+}
+
+bool satisfies_guesses(const Query& query, const std::uint32_t code)
+{
+    return std::all_of(query.guesses.begin(), query.guesses.end(),
+        [code](const Constraints& guess) { return guess.matches(code); });
+}
+
+void narrow_by_guess(const Dictionary& dictionary, const std::uint32_t guessCode, const std::uint8_t pattern,
+        const Constraints& constraints, std::vector<std::uint32_t>& candidates)
+{
+    const FeedbackTable* table = dictionary.feedback_table();
+    const std::uint8_t* row = (table != nullptr) ? table->find_row(guessCode) : nullptr;
+    if (row != nullptr) {
+        narrow_by_pattern(row, pattern, candidates);
+    } else {
+        narrow_candidates(dictionary.packed(), constraints, candidates);
+    }
+}
+
+namespace {
+
+// Letters the query already tells something about: excluded, required,
+// known at a position or played in a guess.
+std::uint32_t tested_letters(const Query& query)
+{
+    std::uint32_t letters = query.filter.excluded | query.filter.required;
+    for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+        if (letter_at(query.filter.knownMask, i) != 0) {
+            letters |= 1u << letter_at(query.filter.knownValue, i);
+        }
+    }
+    for (const std::uint32_t code : query.guessCodes) {
+        for (std::size_t i = 0; i < WORDLE_WORD_LEN; i++) {
+            letters |= 1u << letter_at(code, i);
+        }
+    }
+    return letters;
+}
+
+// find_matches without the stats.
+std::vector<std::uint32_t> scan_words(const Dictionary& dictionary, const Query& query, std::ostream& err)
+{
+    std::vector<std::uint32_t> matches;
+
+    // The first pass also applies what the kernels can test of the first
+    // guess; the guesses are then checked in full on the survivors only.
+    KernelQuery filter;
+    if (!first_pass_filter(query, filter)) {
+        return matches;
+    }
+
+    if (query.length != WORDLE_WORD_LEN) {
+        const WordTable words = dictionary.words(query.length);
+        matches.resize(words.count);
+        const auto start = std::chrono::steady_clock::now();
+        const LengthFilter lengthFilter = select_length_filter(query.length);
+        const std::size_t numMatches = parallel_filter(words.count, query.numThreads, MIN_WORDS_PER_THREAD, matches.data(),
+            [&](const std::size_t begin, const std::size_t end, std::uint32_t* out) {
+                const WordTable range{words.data + (begin * words.length), end - begin, words.length};
+                return lengthFilter(range, query.letters, out);
+            });
+        const auto stop = std::chrono::steady_clock::now();
+        matches.resize(numMatches);
+        if (query.verbose) {
+            err << "Query latency: " << std::chrono::duration<double, std::micro>(stop - start).count()
+                << " us (" << numMatches << " of " << words.count << " words, " << query.length << " letters, "
+                << query.numThreads << " threads)\n";
+        }
+        if (query.counts.bounded()) {
+            narrow_by_counts(words, query.counts, matches);
+        }
+        return matches;
+    }
+
+    if (query.usePostings) {
+        const PostingIndex& postings = dictionary.postings();
+        // Allocated up front so the latency covers only the query itself.
+        std::vector<std::uint64_t> matchBits((postings.size() / 64) + 1);
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t numMatches = postings.query(filter, matchBits);
+        const auto stop = std::chrono::steady_clock::now();
+        collect_matches(matchBits, matches);
+        if (query.verbose) {
+            err << "Query latency: " << std::chrono::duration<double, std::micro>(stop - start).count()
+                << " us (" << numMatches << " of " << postings.size() << " words, postings)\n";
+        }
+    } else {
+        const PackedView packedWords = dictionary.packed();
+        matches.resize(packedWords.size());
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t numMatches = parallel_filter(packedWords.size(), query.numThreads, MIN_WORDS_PER_THREAD,
+            matches.data(), [&](const std::size_t begin, const std::size_t end, std::uint32_t* out) {
+                return query.kernel.run(packedWords.slice(begin, end - begin), filter, out);
+            });
+        const auto stop = std::chrono::steady_clock::now();
+        matches.resize(numMatches);
+        if (query.verbose) {
+            err << "Query latency: " << std::chrono::duration<double, std::micro>(stop - start).count()
+                << " us (" << numMatches << " of " << packedWords.size() << " words, " << query.kernel.name << ", "
+                << query.numThreads << " threads)\n";
+        }
+    }
+
+    if (query.counts.bounded()) {
+        narrow_by_counts(dictionary.letter_counts(), query.counts, matches);
+        if (query.verbose) {
+            err << "After -count: " << matches.size() << " candidates\n";
+        }
+    }
+    for (std::size_t g = 0; g < query.guesses.size(); g++) {
+        narrow_by_guess(dictionary, query.guessCodes[g], query.guessPatterns[g], query.guesses[g], matches);
+        if (query.verbose) {
+            err << "After " << query.guessParams[g] << ": " << matches.size() << " candidates\n";
+        }
+    }
+    return matches;
+}
+
+} // namespace
+
+std::vector<std::uint32_t> find_matches(const Dictionary& dictionary, const Query& query, QueryStats* stats,
+        std::ostream& err)
+{
+    const auto scanStart = std::chrono::steady_clock::now();
+    std::vector<std::uint32_t> matches = scan_words(dictionary, query, err);
+    if (stats != nullptr) {
+        stats->scanMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - scanStart).count();
+        stats->rejectedGuess = count_rejections(dictionary, query, *stats) - matches.size();
+        stats->matched = matches.size();
+    }
+    return matches;
+}
+
+std::size_t find_matches(const Dictionary& dictionary, const Query& query, std::uint32_t* out,
+        const std::size_t capacity)
+{
+    KernelQuery filter;
+    if ((capacity == 0) || !first_pass_filter(query, filter)) {
+        return 0;
+    }
+    const WordTable words = dictionary.words(query.length);
+    const PackedView packedWords = dictionary.packed();
+    const bool packed = query.length == WORDLE_WORD_LEN;
+    const LengthFilter lengthFilter = packed ? nullptr : select_length_filter(query.length);
+    const LetterCounts* counts = (packed && query.counts.bounded()) ? dictionary.letter_counts() : nullptr;
+
+    // The masks (and the first guess) as in scan_words, then the -count
+    // bounds and the guesses in full on each word that passed them.
+    const auto firstPass = [&](const std::size_t begin, const std::size_t end, std::uint32_t* passed) {
+        if (packed) {
+            return query.kernel.run(packedWords.slice(begin, end - begin), filter, passed);
+        }
+        const WordTable range{words.data + (begin * words.length), end - begin, words.length};
+        return lengthFilter(range, query.letters, passed);
+    };
+    const auto matches = [&](const std::uint32_t w) {
+        if (query.counts.bounded()
+                && !query.counts.matches(counts != nullptr ? counts[w] : count_letters(words.word(w).data(), words.length))) {
+            return false;
+        }
+        return query.guesses.empty() || satisfies_guesses(query, packedWords.codes[w]);
+    };
+
+    std::size_t numWritten = 0;
+    if (capacity >= words.count) {
+        // Room for every word: filter straight into out on all the threads
+        // and compact the survivors in place.
+        const std::size_t numPassed = parallel_filter(words.count, query.numThreads, MIN_WORDS_PER_THREAD, out, firstPass);
+        for (std::size_t i = 0; i < numPassed; i++) {
+            if (matches(out[i])) {
+                out[numWritten++] = out[i];
+            }
+        }
+        return numWritten;
+    }
+    // Otherwise one tile at a time, stopping as soon as out is full.
+    std::vector<std::uint32_t> tileMatches(std::min(TILE_WORDS, words.count));
+    for (std::size_t first = 0; (first < words.count) && (numWritten < capacity); first += TILE_WORDS) {
+        const std::size_t numPassed = firstPass(first, std::min(words.count, first + TILE_WORDS), tileMatches.data());
+        for (std::size_t i = 0; (i < numPassed) && (numWritten < capacity); i++) {
+            const std::uint32_t w = static_cast<std::uint32_t>(first + tileMatches[i]);
+            if (matches(w)) {
+                out[numWritten++] = w;
+            }
+        }
+    }
+    return numWritten;
+}
+
+void print_results(const Dictionary& dictionary, const Query& query,
+        const std::vector<std::uint32_t>& matches, std::ostream& out, std::ostream& err)
+{
+    const WordTable words = dictionary.words(query.length);
+    if (query.coverCount > 0) {
+        const auto start = std::chrono::steady_clock::now();
+        const Cover cover = find_cover(dictionary.packed(), tested_letters(query), query.coverCount, query.numThreads);
+        const auto stop = std::chrono::steady_clock::now();
+        if (query.verbose) {
+            err << "Searched covers of " << query.coverCount << " words in "
+                << std::chrono::duration<double, std::milli>(stop - start).count() << " ms ("
+                << query.numThreads << " threads)\n";
+        }
+        for (const std::uint32_t w : cover.words) {
+            out << words.word(w) << " ";
+        }
+        out << __builtin_popcount(cover.letters) << "\n";
+        return;
+    }
+    if (query.rankCount > 0) {
+        for (const RankedWord& ranked : rank_by_letter_frequency(words, matches, query.rankCount)) {
+            out << words.word(ranked.index) << " " << ranked.score << "\n";
+        }
+        return;
+    }
+    if (query.suggestCount == 0) {
+        for (const std::uint32_t w : matches) {
+            out << words.word(w) << "\n";
+        }
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<Suggestion> suggestions =
+        suggest_guesses(dictionary.packed(), matches, query.score, query.suggestCount, query.numThreads);
+    const auto stop = std::chrono::steady_clock::now();
+    if (query.verbose) {
+        err << "Scored " << dictionary.packed().size() << " guesses against " << matches.size() << " candidates in "
+            << std::chrono::duration<double, std::milli>(stop - start).count() << " ms ("
+            << query.numThreads << " threads)\n";
+    }
+    for (const Suggestion& suggestion : suggestions) {
+        out << words.word(suggestion.word) << " " << suggestion.score << "\n";
+    }
+}
+
+int run_query(const std::vector<std::string>& args, const Dictionary& dictionary, std::ostream& out, std::ostream& err)
+{
+    Query query;
+    if (!parse_query(args, query, err)) {
+        return EXIT_FAILURE;
+    }
+    print_results(dictionary, query, find_matches(dictionary, query, nullptr, err), out, err);
+    return EXIT_SUCCESS;
+}
+
+QueryHandler make_session_handler(const Dictionary& dictionary)
+{
+    struct Game {
+        bool started = false;
+        std::vector<std::uint32_t> candidates;
+    };
+    auto game = std::make_shared<Game>();
+
+    return [&dictionary, game](const std::vector<std::string>& args, std::ostream& out, std::ostream& err) {
+        if (args.front() == "reset") {
+            *game = Game();
+            return EXIT_SUCCESS;
+        }
+        if (args.front() == "suggest") {
+            Query query;
+            query.suggestCount = (args.size() > 1) ? std::strtoul(args[1].c_str(), nullptr, 10) : 0;
+            query.numThreads = default_thread_count();
+            if (query.suggestCount == 0) {
+                err << "Error: Expected suggest <count>, e.g. suggest 5.\n";
+                return EXIT_FAILURE;
+            }
+            std::vector<std::uint32_t> candidates = game->candidates;
+            if (!game->started) {
+                candidates.resize(dictionary.packed().size());
+                for (std::size_t w = 0; w < candidates.size(); w++) {
+                    candidates[w] = static_cast<std::uint32_t>(w);
+                }
+            }
+            print_results(dictionary, query, candidates, out, err);
+            return EXIT_SUCCESS;
+        }
+        if (args.front() != "guess") {
+            return run_query(args, dictionary, out, err);
+        }
+
+        const PackedView words = dictionary.packed();
+        for (std::size_t i = 1; i < args.size(); i++) {
+            std::string guess;
+            std::string feedback;
+            std::string error;
+            Constraints guessConstraints;
+            std::uint8_t pattern = 0;
+            if (!split_guess_param(args[i], guess, feedback)) {
+                err << "Error: Expected guess <word>:<feedback>, e.g. guess crane:gybbg.\n";
+                return EXIT_FAILURE;
+            }
+            if (!guessConstraints.add_guess(guess, feedback, error)) {
+                err << "Error: " << error << "\n";
+                return EXIT_FAILURE;
+            }
+            parse_feedback(feedback, pattern);
+            pattern = canonical_feedback(pack_code(guess), pattern);
+            if (!game->started) {
+                // First guess of the game: one kernel pass over every word.
+                game->candidates.resize(words.size());
+                game->candidates.resize(select_filter_kernel().run(words, guessConstraints.prefilter(), game->candidates.data()));
+                game->started = true;
+            }
+            narrow_by_guess(dictionary, pack_code(guess), pattern, guessConstraints, game->candidates);
+        }
+
+        const WordTable& table = dictionary.words();
+        for (const std::uint32_t w : game->candidates) {
+            out << table.word(w) << "\n";
+        }
+        return EXIT_SUCCESS;
+    };
+}
+
+} // namespace set_solver
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "constraints.hpp"
+#include "cover.hpp"
+#include "feedback_table.hpp"
+#include "filter_kernel.hpp"
+#include "length_filter.hpp"
+#include "letter_counts.hpp"
+#include "query_server.hpp"
+#include "query_stats.hpp"
+#include "packed_words.hpp"
+#include "posting_index.hpp"
+#include "suggest.hpp"
+#include "word_index.hpp"
+
+namespace set_solver {
+
+// A word list loaded once and shared, read-only, by any number of queries.
+class Dictionary {
+public:
+    // A large word list is parsed and packed on up to numThreads threads.
+    // "" loads the bundled word list.
+    bool load(const std::string& wordFilePath, std::size_t numThreads, std::ostream& err);
+
+    // The 5-letter words, which are also packed.
+    const WordTable& words() const { return wordTable; }
+    // The words of any other length, for -length.
+    WordTable words(std::size_t length) const { return index.words(length); }
+    PackedView packed() const { return packedWords.view(); }
+    // Letter counts of the 5-letter words, in the same order, for -count.
+    // Built on first use; safe to call from several threads.
+    const LetterCounts* letter_counts() const;
+    const WordIndex& word_index() const { return index; }
+    // How the index was loaded, plus the time to pack the words, for --stats.
+    const LoadStats& load_stats() const { return loadStats; }
+
+    // Built on first use; safe to call from several threads.
+    const PostingIndex& postings() const;
+
+    // Map a table from build-feedback-table whose answers are exactly this
+    // word list; guesses in it are then applied with one row lookup.
+    bool load_feedback_table(const std::string& tablePath, std::ostream& err);
+    const FeedbackTable* feedback_table() const { return table.get(); }
+
+private:
+    WordIndex index;
+    LoadStats loadStats;
+    WordTable wordTable;
+    PackedWords packedWords;
+    std::unique_ptr<FeedbackTable> table;
+    mutable std::once_flag postingsBuilt;
+    mutable std::unique_ptr<PostingIndex> postingIndex;
+    mutable std::once_flag letterCountsBuilt;
+    mutable std::vector<LetterCounts> letterCounts;
+};
+
+// A parsed -exclude/-require/-known/-count/-guess query and how to evaluate it.
+struct Query {
+    // -length: 5-letter queries run on the packed words, any other length
+    // on the length filter for it, with letters only.
+    std::size_t length = WORDLE_WORD_LEN;
+    LetterQuery letters;
+    // -exclude/-require/-known, which a filter kernel tests exactly.
+    // Letters a -count or -anagram requires or rules out are folded in.
+    KernelQuery filter;
+    // -count/-anagram, checked on the survivors of the filter.
+    CountQuery counts;
+    // One entry per -guess, applied in order to the survivors of the filter.
+    std::vector<std::string> guessParams;
+    std::vector<Constraints> guesses;
+    // The same guesses as packed word and feedback pattern, for table lookups.
+    std::vector<std::uint32_t> guessCodes;
+    std::vector<std::uint8_t> guessPatterns;
+    FilterKernelInfo kernel;
+    bool usePostings = false;
+    bool verbose = false;
+    // --suggest N: print the N best next guesses instead of the matches.
+    std::size_t suggestCount = 0;
+    GuessScore score = GuessScore::Entropy;
+    // --rank / --top K: print the best rankCount matches by letter
+    // frequency (SIZE_MAX for all of them) instead of list order.
+    std::size_t rankCount = 0;
+    // --cover k: print the k words covering the most untested letters.
+    std::size_t coverCount = 0;
+    std::size_t numThreads = 1;
+};
+
+// The constraints of a query as values rather than command line arguments,
+// for use as a library: the letters of exclude and require run together
+// ("moac"), known, count and guesses are as for -known, -count and -guess.
+struct QueryConstraints {
+    std::size_t length = WORDLE_WORD_LEN;
+    std::string exclude;
+    std::string require;
+    std::string known;
+    std::string count;
+    std::vector<std::string> guesses;
+};
+
+std::bitset<26> get_letters_from_param(const std::string& param);
+
+// Parse the query options of args; errors are reported to err.
+bool parse_query(const std::vector<std::string>& args, Query& query, std::ostream& err);
+
+// Compile constraints into a query as parse_query would the equivalent
+// arguments, filtering on up to numThreads threads.
+bool compile_query(const QueryConstraints& constraints, std::size_t numThreads, Query& query, std::ostream& err);
+
+// The kernel query for the first pass over the words: the filter combined
+// with what can be tested of the first guess. False if nothing can match.
+bool first_pass_filter(const Query& query, KernelQuery& filter);
+
+// Full check of a word that passed first_pass_filter against every guess.
+bool satisfies_guesses(const Query& query, std::uint32_t code);
+
+// Keep the candidates consistent with one guess: a row lookup if the
+// dictionary has a feedback table containing the guess, else a full check.
+void narrow_by_guess(const Dictionary& dictionary, std::uint32_t guessCode, std::uint8_t pattern,
+        const Constraints& constraints, std::vector<std::uint32_t>& candidates);
+
+// Indices of the matching words, in word list order. Large lists are
+// split into ranges filtered on up to query.numThreads threads.
+// Unless stats is null, the scan time and the rejections are added to it.
+// With query.verbose the query latency is reported to err.
+std::vector<std::uint32_t> find_matches(const Dictionary& dictionary, const Query& query, QueryStats* stats,
+        std::ostream& err);
+
+// find_matches into a caller's buffer: writes the first matches, up to
+// capacity, straight to out and returns how many it wrote. The scan stops
+// once out is full; with room for every word of the length it runs on
+// query.numThreads threads.
+std::size_t find_matches(const Dictionary& dictionary, const Query& query, std::uint32_t* out, std::size_t capacity);
+
+// Print the matches, ranked with --rank or --top, or with --suggest the best
+// guesses against them, one per line; with --cover the best elimination
+// guesses instead, on one line.
+void print_results(const Dictionary& dictionary, const Query& query,
+        const std::vector<std::uint32_t>& matches, std::ostream& out, std::ostream& err);
+
+// Parse args, run the query and print the results to out.
+int run_query(const std::vector<std::string>& args, const Dictionary& dictionary, std::ostream& out, std::ostream& err);
+
+// Handler for one --serve connection. Besides stateless queries it keeps
+// a game: "guess crane:gybbg [pilot:bbybb ...]" narrows the connection's
+// remaining candidates (only the survivors are rechecked) and prints them,
+// "suggest N" ranks the best next guesses against them and "reset" starts
+// over with the whole word list.
+QueryHandler make_session_handler(const Dictionary& dictionary);
+
+} // namespace set_solver
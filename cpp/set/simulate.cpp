@@ -0,0 +1,177 @@
+#include "simulate.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "feedback.hpp"
+#include "parallel.hpp"
+
+namespace set_solver {
+
+namespace {
+
+// Wordle allows six guesses; games that need more count as failures.
+constexpr std::size_t MAX_WORDLE_GUESSES = 6;
+
+// A game still unsolved after this many guesses is abandoned. Candidates are
+// words with distinct codes, so while more than one is left the best guess
+// splits them and every guess removes at least one: this only guards against
+// bugs.
+constexpr std::size_t MAX_GUESSES = 32;
+
+// The strategy's guesses, memoized by the feedback that led to them.
+class Strategy {
+public:
+    Strategy(const PackedView& words, const GuessScore score)
+        : words(words), score(score)
+    {
+    }
+
+    // The guess to play after the feedback patterns in path, given the
+    // candidates they leave. Concurrent callers with the same path wait for
+    // a single computation.
+    std::uint32_t next_guess(const std::string& path, const std::vector<std::uint32_t>& candidates,
+            const std::size_t numThreads)
+    {
+        std::shared_ptr<Decision> decision;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::shared_ptr<Decision>& entry = decisions[path];
+            if (entry == nullptr) {
+                entry = std::make_shared<Decision>();
+            }
+            decision = entry;
+        }
+        std::call_once(decision->computed, [&] {
+            // One candidate left, or two: guessing one of them is never worse.
+            decision->guess = (candidates.size() <= 2)
+                ? candidates.front()
+                : suggest_guesses(words, candidates, score, 1, numThreads).front().word;
+        });
+        return decision->guess;
+    }
+
+private:
+    struct Decision {
+        std::once_flag computed;
+        std::uint32_t guess = 0;
+    };
+
+    const PackedView words;
+    const GuessScore score;
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Decision>> decisions;
+};
+
+// Play one game from the candidates allWords; returns the guesses made, the
+// last one being the answer (or a word that differs from it only in case)
+// unless the game was abandoned.
+std::vector<std::uint32_t> play_game(const PackedView& words, Strategy& strategy,
+        const std::vector<std::uint32_t>& allWords, const std::uint32_t answer)
+{
+    std::vector<std::uint32_t> guesses;
+    std::vector<std::uint32_t> candidates = allWords;
+
+    const FeedbackKernel feedback = select_feedback_kernel();
+    std::vector<std::uint32_t> codes;
+    std::vector<std::uint8_t> patterns;
+    std::string path;
+    while (guesses.size() < MAX_GUESSES) {
+        const std::uint32_t guess = strategy.next_guess(path, candidates, 1);
+        guesses.push_back(guess);
+        const std::uint8_t pattern = compute_feedback(words.codes[guess], words.codes[answer]);
+        if (pattern == ALL_GREEN) {
+            break;
+        }
+        codes.resize(candidates.size());
+        patterns.resize(candidates.size());
+        for (std::size_t c = 0; c < candidates.size(); c++) {
+            codes[c] = words.codes[candidates[c]];
+        }
+        feedback(words.codes[guess], codes.data(), codes.size(), patterns.data());
+        std::size_t numLeft = 0;
+        for (std::size_t c = 0; c < candidates.size(); c++) {
+            candidates[numLeft] = candidates[c];
+            numLeft += patterns[c] == pattern;
+        }
+        candidates.resize(numLeft);
+        path += static_cast<char>(pattern);
+    }
+    return guesses;
+}
+
+} // namespace
+
+int run_simulation(const Dictionary& dictionary, const std::vector<std::uint32_t>& answers,
+        const GuessScore score, const std::size_t numThreads, const bool verbose, std::ostream& out, std::ostream& err)
+{
+    const PackedView words = dictionary.packed();
+    if (words.size() == 0) {
+        err << "Error: The word list is empty.\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Strategy strategy(words, score);
+
+    // The opening guess is shared by every game: rank it with all threads.
+    const std::vector<std::uint32_t> allWords = distinct_words(words);
+    strategy.next_guess("", allWords, numThreads);
+
+    std::vector<std::vector<std::uint32_t>> games(answers.size());
+    parallel_for_dynamic(answers.size(), numThreads, 1, [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t g = begin; g < end; g++) {
+            games[g] = play_game(words, strategy, allWords, answers[g]);
+        }
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // ----------
+    // SUMMARIZE
+    // ----------
+    const WordTable& table = dictionary.words();
+    std::vector<std::size_t> histogram(MAX_GUESSES + 1, 0);
+    std::size_t totalGuesses = 0;
+    std::size_t worst = 0;
+    std::size_t failures = 0;
+    std::size_t abandoned = 0;
+    for (std::size_t g = 0; g < games.size(); g++) {
+        const std::vector<std::uint32_t>& guesses = games[g];
+        const bool solved = words.codes[guesses.back()] == words.codes[answers[g]];
+        if (verbose) {
+            out << table.word(answers[g]) << ":";
+            for (const std::uint32_t guess : guesses) {
+                out << " " << table.word(guess);
+            }
+            out << (solved ? "\n" : " (abandoned)\n");
+        }
+        abandoned += !solved;
+        histogram[guesses.size()]++;
+        totalGuesses += guesses.size();
+        worst = std::max(worst, guesses.size());
+        failures += guesses.size() > MAX_WORDLE_GUESSES;
+    }
+
+    const std::size_t numGames = answers.size();
+    out << "Games: " << numGames << "\n";
+    for (std::size_t n = 1; n <= worst; n++) {
+        out << "Solved in " << n << ": " << histogram[n] << "\n";
+    }
+    out << "Mean guesses: " << (numGames > 0 ? static_cast<double>(totalGuesses) / numGames : 0.0) << "\n";
+    out << "Worst case: " << worst << "\n";
+    out << "Failed (more than " << MAX_WORDLE_GUESSES << " guesses): " << failures << " ("
+        << (numGames > 0 ? 100.0 * failures / numGames : 0.0) << "%)\n";
+    if (abandoned > 0) {
+        out << "Abandoned: " << abandoned << "\n";
+    }
+    err << "Simulated " << numGames << " games in " << seconds << " s (" << (numGames / seconds) << " games/s, "
+        << numThreads << " threads)\n";
+    return EXIT_SUCCESS;
+}
+
+} // namespace set_solver
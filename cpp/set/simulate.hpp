@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "query.hpp"
+#include "suggest.hpp"
+
+namespace set_solver {
+
+// Simulate mode: play one game for each of answers (indices into the
+// dictionary) with the built-in strategy and report
+//   - how many games took 1, 2, ... guesses, the mean and the worst case,
+//   - how many needed more than 6 guesses,
+// on out, and the wall time and games per second on err, so that out is
+// identical from run to run and can be diffed against an earlier one.
+//
+// The strategy starts from the whole dictionary, keeping one word of each
+// group that differs only in case, and always plays the best guess by score
+// (see suggest_guesses). A game ends when the guess matches the answer up to
+// case. The strategy depends only on the feedback seen so far, so each
+// decision is computed once and shared by every game that reaches it. Games run on numThreads threads; with verbose, every
+// game's guesses are also listed, in the order of answers.
+int run_simulation(const Dictionary& dictionary, const std::vector<std::uint32_t>& answers,
+        GuessScore score, std::size_t numThreads, bool verbose, std::ostream& out, std::ostream& err);
+
+} // namespace set_solver
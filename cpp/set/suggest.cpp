@@ -0,0 +1,181 @@
+#include "suggest.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "feedback.hpp"
+#include "parallel.hpp"
+
+namespace set_solver {
+
+namespace {
+
+// Guesses taken at a time by a thread; a few hundred microseconds of work
+// on the full word list, small enough to balance the tail.
+constexpr std::size_t GUESS_GRAIN = 16;
+
+// Answers whose feedback is computed before it is counted.
+constexpr std::size_t PATTERN_BLOCK = 2048;
+// Interleaved histograms, so that runs of one pattern (mostly all black)
+// do not serialize on a single counter.
+constexpr std::size_t NUM_HISTOGRAMS = 4;
+
+double score_buckets(const std::uint32_t* sizes, const std::size_t numBuckets, const std::size_t numCandidates,
+        const GuessScore score)
+{
+    // n log2 n for the bucket sizes of small candidate sets, where the
+    // logarithms would otherwise cost more than computing the feedback.
+    static const std::vector<double> N_LOG2_N = [] {
+        std::vector<double> table(PATTERN_BLOCK + 1, 0.0);
+        for (std::size_t n = 1; n <= PATTERN_BLOCK; n++) {
+            table[n] = n * std::log2(static_cast<double>(n));
+        }
+        return table;
+    }();
+
+    const double total = static_cast<double>(numCandidates);
+    double sum = 0;
+    for (std::size_t b = 0; b < numBuckets; b++) {
+        const double n = static_cast<double>(sizes[b]);
+        if (score == GuessScore::Remaining) {
+            sum += n * n;
+        } else {
+            sum += (sizes[b] <= PATTERN_BLOCK) ? N_LOG2_N[sizes[b]] : n * std::log2(n);
+        }
+    }
+    // Entropy: -sum(p log2 p) = log2 N - sum(n log2 n) / N
+    // Remaining: sum(p * n) = sum(n^2) / N
+    return (score == GuessScore::Entropy) ? std::log2(total) - (sum / total) : sum / total;
+}
+
+// Per-thread buffers for scoring guesses. The histograms are all zero
+// between two guesses.
+struct Scratch {
+    std::array<std::uint8_t, PATTERN_BLOCK> patterns;
+    std::array<std::array<std::uint32_t, NUM_PATTERNS>, NUM_HISTOGRAMS> counts{};
+    std::array<std::uint8_t, NUM_PATTERNS> used;
+    std::array<std::uint32_t, NUM_PATTERNS> sizes;
+};
+
+double score_guess(const std::uint32_t guess, const std::vector<std::uint32_t>& answers,
+        const FeedbackKernel feedback, const GuessScore score, Scratch& scratch)
+{
+    std::array<std::uint32_t, NUM_PATTERNS>& histogram = scratch.counts[0];
+    std::size_t numBuckets = 0;
+
+    // Few candidates (as late in a game): one histogram, and only the
+    // buckets actually used are read back and cleared.
+    if (answers.size() <= PATTERN_BLOCK) {
+        feedback(guess, answers.data(), answers.size(), scratch.patterns.data());
+        for (std::size_t a = 0; a < answers.size(); a++) {
+            const std::uint8_t pattern = scratch.patterns[a];
+            scratch.used[numBuckets] = pattern;
+            numBuckets += histogram[pattern]++ == 0;
+        }
+        for (std::size_t b = 0; b < numBuckets; b++) {
+            scratch.sizes[b] = histogram[scratch.used[b]];
+            histogram[scratch.used[b]] = 0;
+        }
+        return score_buckets(scratch.sizes.data(), numBuckets, answers.size(), score);
+    }
+
+    for (std::size_t first = 0; first < answers.size(); first += PATTERN_BLOCK) {
+        const std::size_t n = std::min(PATTERN_BLOCK, answers.size() - first);
+        feedback(guess, answers.data() + first, n, scratch.patterns.data());
+        std::size_t a = 0;
+        for (; a + NUM_HISTOGRAMS <= n; a += NUM_HISTOGRAMS) {
+            for (std::size_t h = 0; h < NUM_HISTOGRAMS; h++) {
+                scratch.counts[h][scratch.patterns[a + h]]++;
+            }
+        }
+        for (; a < n; a++) {
+            histogram[scratch.patterns[a]]++;
+        }
+    }
+    for (std::size_t p = 0; p < NUM_PATTERNS; p++) {
+        std::uint32_t size = 0;
+        for (std::array<std::uint32_t, NUM_PATTERNS>& partial : scratch.counts) {
+            size += partial[p];
+            partial[p] = 0;
+        }
+        scratch.sizes[numBuckets] = size;
+        numBuckets += size != 0;
+    }
+    return score_buckets(scratch.sizes.data(), numBuckets, answers.size(), score);
+}
+
+} // namespace
+
+bool parse_score(const std::string_view name, GuessScore& score)
+{
+    if (name == "entropy") {
+        score = GuessScore::Entropy;
+        return true;
+    }
+    if (name == "remaining") {
+        score = GuessScore::Remaining;
+        return true;
+    }
+    return false;
+}
+
+std::vector<Suggestion> suggest_guesses(const PackedView& words, const std::vector<std::uint32_t>& candidates,
+        const GuessScore score, const std::size_t count, const std::size_t numThreads)
+{
+    return suggest_guesses(words, std::vector<std::vector<std::uint32_t>>{candidates}, score, count, numThreads);
+}
+
+std::vector<Suggestion> suggest_guesses(const PackedView& words, const std::vector<std::vector<std::uint32_t>>& boards,
+        const GuessScore score, const std::size_t count, const std::size_t numThreads)
+{
+    // Gather each board's candidates' codes so the kernel streams through
+    // them; boards without candidates add nothing to any score.
+    std::vector<std::vector<std::uint32_t>> answers;
+    std::vector<std::uint8_t> isCandidate(words.size(), 0);
+    for (const std::vector<std::uint32_t>& candidates : boards) {
+        if (candidates.empty()) {
+            continue;
+        }
+        std::vector<std::uint32_t>& codes = answers.emplace_back(candidates.size());
+        for (std::size_t a = 0; a < candidates.size(); a++) {
+            codes[a] = words.codes[candidates[a]];
+            isCandidate[candidates[a]] = 1;
+        }
+    }
+    if (answers.empty()) {
+        return {};
+    }
+
+    std::vector<Suggestion> suggestions(words.size());
+    const FeedbackKernel feedback = select_feedback_kernel();
+    parallel_for_dynamic(words.size(), numThreads, GUESS_GRAIN, [&](const std::size_t begin, const std::size_t end) {
+        Scratch scratch;
+        for (std::size_t g = begin; g < end; g++) {
+            double total = 0;
+            for (const std::vector<std::uint32_t>& codes : answers) {
+                total += score_guess(words.codes[g], codes, feedback, score, scratch);
+            }
+            suggestions[g] = {static_cast<std::uint32_t>(g), total};
+        }
+    });
+
+    const bool higherIsBetter = score == GuessScore::Entropy;
+    const auto better = [&](const Suggestion& a, const Suggestion& b) {
+        if (a.score != b.score) {
+            return higherIsBetter ? (a.score > b.score) : (a.score < b.score);
+        }
+        if (isCandidate[a.word] != isCandidate[b.word]) {
+            return isCandidate[a.word] > isCandidate[b.word];
+        }
+        return a.word < b.word;
+    };
+
+    const std::size_t numBest = std::min(count, suggestions.size());
+    std::partial_sort(suggestions.begin(), suggestions.begin() + numBest, suggestions.end(), better);
+    suggestions.resize(numBest);
+    return suggestions;
+}
+
+} // namespace set_solver
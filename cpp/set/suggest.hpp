@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "packed_words.hpp"
+
+namespace set_solver {
+
+// How a guess is scored against the remaining candidates.
+enum class GuessScore {
+    // Expected information in bits: the entropy of the distribution of
+    // feedback patterns over the candidates. Higher is better.
+    Entropy,
+    // Expected number of candidates left after the guess. Lower is better.
+    Remaining,
+};
+
+// "entropy" or "remaining"; false for any other name.
+bool parse_score(std::string_view name, GuessScore& score);
+
+struct Suggestion {
+    std::uint32_t word;
+    double score;
+};
+
+// Score every word of `words` as a guess against `candidates` (indices into
+// words) and return the best `count`, best first. Ties go to guesses that
+// are themselves candidates, then to the earlier word.
+//
+// The guesses are spread over numThreads threads with work stealing; each
+// guess costs one feedback computation per candidate.
+std::vector<Suggestion> suggest_guesses(const PackedView& words, const std::vector<std::uint32_t>& candidates,
+        GuessScore score, std::size_t count, std::size_t numThreads);
+
+// The same against several boards at once (Quordle, Octordle): a guess
+// scores the sum of its scores against the candidates of every board, so
+// each guess is evaluated once for all of them. Ties go to guesses that
+// are a candidate on any board.
+std::vector<Suggestion> suggest_guesses(const PackedView& words, const std::vector<std::vector<std::uint32_t>>& boards,
+        GuessScore score, std::size_t count, std::size_t numThreads);
+
+} // namespace set_solver
@@ -0,0 +1,82 @@
+#!/bin/sh
+# Regression tests for the set solver (make test). Each test runs
+# ./wordle_solver on a small word list written to a temporary directory and
+# compares its output with the expected lines.
+
+cd "$(dirname "$0")/.." || exit 1
+solver="$PWD/wordle_solver"
+work=$(mktemp -d) || exit 1
+trap 'rm -rf "$work"' EXIT
+failures=0
+
+# expect <name> <expected output> <command...>
+expect() {
+    name=$1
+    expected=$2
+    shift 2
+    actual=$("$@" 2>&1)
+    if [ "$actual" = "$expected" ]; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name"
+        echo "  expected: $(echo "$expected" | tr '\n' ' ')"
+        echo "  actual:   $(echo "$actual" | tr '\n' ' ')"
+        failures=$((failures + 1))
+    fi
+}
+
+# Run a command with its timing report on stderr discarded.
+quiet() {
+    "$@" 2>/dev/null
+}
+
+# -guess with a repeated letter whose yellow is on its second occurrence:
+# Wordle would mark the first one, but both say "one e, not here", and the
+# feedback table must agree with the full check.
+printf 'eerie\nmetal\ncloth\nsheep\nnewly\ndozen\nabbey\npiece\nhaven\ntweak\n' > "$work/repeated.txt"
+"$solver" build-feedback-table -list "$work/repeated.txt" > /dev/null
+repeated=$(printf 'dozen\nabbey\nhaven\ntweak')
+expect "repeated letter, full check" "$repeated" \
+    "$solver" -list "$work/repeated.txt" -guess eerie:bybbb
+expect "repeated letter, feedback table" "$repeated" \
+    "$solver" -list "$work/repeated.txt" --table="$work/repeated.txt.fbt" -guess eerie:bybbb
+
+# A word listed twice in different case is one answer, and a game ends when
+# the guess matches the answer up to case.
+printf 'crane\nCrane\nslate\nplate\ncrate\ntrace\n' > "$work/duplicate.txt"
+printf 'Crane\n' > "$work/duplicate-answer.txt"
+expect "duplicate word, simulate" "$(printf '%s\n' 'crane: slate crane' 'slate: slate' 'plate: slate plate' \
+        'crate: slate crate' 'trace: slate trace' 'Games: 5' 'Solved in 1: 1' 'Solved in 2: 4' \
+        'Mean guesses: 1.8' 'Worst case: 2' 'Failed (more than 6 guesses): 0 (0%)')" \
+    quiet "$solver" simulate -list "$work/duplicate.txt" --verbose
+expect "duplicate word, simulate one answer" "$(printf '%s\n' 'crane: slate crane' 'Games: 1' 'Solved in 1: 0' \
+        'Solved in 2: 1' 'Mean guesses: 2' 'Worst case: 2' 'Failed (more than 6 guesses): 0 (0%)')" \
+    quiet "$solver" simulate -list "$work/duplicate.txt" -answers "$work/duplicate-answer.txt" --verbose
+
+# A decision tree counts an answer listed twice in different case once.
+printf 'crane\nCrane\nslate\n' > "$work/duplicate-answers.txt"
+expect "duplicate word, build-tree" "$(printf '%s\n' "Wrote \"$work/duplicate.tree\" (2 nodes, 208 bytes)." \
+        'Mean guesses: 1.5, worst case: 2 (2 answers).')" \
+    quiet "$solver" build-tree -list "$work/duplicate.txt" -answers "$work/duplicate-answers.txt" \
+        -o "$work/duplicate.tree"
+expect "duplicate word, tree lookup" "Solved." \
+    "$solver" --tree="$work/duplicate.tree" -guess crane:ggggg
+
+# -width and -depth take whole numbers; -depth 0 is valid.
+expect "build-tree -width 0" "Error: -width must be a positive number." \
+    "$solver" build-tree -list "$work/duplicate.txt" -o "$work/invalid.tree" -width 0
+expect "build-tree -depth x" "Error: -depth must be a number." \
+    "$solver" build-tree -list "$work/duplicate.txt" -o "$work/invalid.tree" -depth x
+expect "build-tree -depth 0" "Mean guesses: 1.8, worst case: 2 (5 answers)." \
+    sh -c '"$1" build-tree -list "$2" -o "$3" -depth 0 2>/dev/null | tail -n 1' \
+    sh "$solver" "$work/duplicate.txt" "$work/depth0.tree"
+
+# Multi-board mode only filters and suggests.
+expect "multi-board --top" "Error: --rank, --top and --cover are not supported in multi-board mode." \
+    "$solver" -list "$work/duplicate.txt" -board crane:bbbbb -board crane:gbbbb --top 3
+
+if [ "$failures" -ne 0 ]; then
+    echo "$failures test(s) failed."
+    exit 1
+fi
+echo "All tests passed."
@@ -0,0 +1,72 @@
+/*
+ * C interface to the set solver (libwordle.a / libwordle.so), for
+ * calling it in-process from C, Go (cgo), C# (P/Invoke) and the like.
+ *
+ * A dictionary is loaded once and can then be queried from any number of
+ * threads. Functions that can fail return NULL and, if error is not NULL,
+ * write a NUL-terminated message of at most error_size bytes to it.
+ */
+#ifndef WORDLE_H
+#define WORDLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct wordle_dictionary wordle_dictionary;
+typedef struct wordle_query wordle_query;
+
+/* The constraints of a query. NULL or "" leaves one out. */
+typedef struct {
+    /* Word length, 4 to 11; 0 for 5. */
+    size_t length;
+    /* Letters that are not in the word, e.g. "moac". */
+    const char* exclude;
+    /* Letters that are in the word, e.g. "u". */
+    const char* require;
+    /* Known positions as for -known, e.g. "1s,5e". */
+    const char* known;
+    /* Guesses with their feedback as for -guess, e.g. "crane:bybbg". */
+    const char* const* guesses;
+    size_t num_guesses;
+    /* Letter count bounds as for -count, e.g. "e=2,a<=1". */
+    const char* count;
+} wordle_constraints;
+
+/* Load a word list, building or reusing the index next to it, on up to
+ * num_threads threads (0 for one per core). NULL or "" is the bundled
+ * list compiled into the library. */
+wordle_dictionary* wordle_dictionary_load(const char* path, size_t num_threads, char* error, size_t error_size);
+void wordle_dictionary_free(wordle_dictionary* dictionary);
+
+/* Number of words of a length. */
+size_t wordle_dictionary_count(const wordle_dictionary* dictionary, size_t length);
+
+/* Word `index` of a length: `length` letters, not NUL-terminated, valid
+ * until the dictionary is freed. NULL if index is out of range. */
+const char* wordle_dictionary_word(const wordle_dictionary* dictionary, size_t length, uint32_t index);
+
+/* Compile constraints into a query, filtering on up to num_threads threads
+ * (0 for one per core). */
+wordle_query* wordle_query_compile(const wordle_constraints* constraints, size_t num_threads,
+        char* error, size_t error_size);
+void wordle_query_free(wordle_query* query);
+
+/* Length of the words a query matches. */
+size_t wordle_query_length(const wordle_query* query);
+
+/* Write the indices (for wordle_dictionary_word) of the first matching
+ * words, at most capacity, to out in word list order, and return how many
+ * were written. The search stops once out is full, so a capacity of
+ * wordle_dictionary_count(dictionary, length) is needed to get them all. */
+size_t wordle_filter(const wordle_dictionary* dictionary, const wordle_query* query,
+        uint32_t* out, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORDLE_H */
@@ -0,0 +1,145 @@
+#include "wordle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "query.hpp"
+#include "thread_pool.hpp"
+
+struct wordle_dictionary {
+    set_solver::Dictionary dictionary;
+};
+
+struct wordle_query {
+    set_solver::Query query;
+};
+
+namespace {
+
+// Copy message into the caller's buffer, cut to fit and NUL-terminated.
+void report_error(const std::string& message, char* error, const std::size_t errorSize)
+{
+    if ((error == nullptr) || (errorSize == 0)) {
+        return;
+    }
+    const std::size_t length = std::min(message.length(), errorSize - 1);
+    std::memcpy(error, message.data(), length);
+    error[length] = '\0';
+}
+
+// "Error: <message>\n" -> "<message>"
+std::string error_message(const std::string& output)
+{
+    std::string message = output;
+    message.erase(message.find_last_not_of('\n') + 1);
+    if (message.compare(0, 7, "Error: ") == 0) {
+        message.erase(0, 7);
+    }
+    return message;
+}
+
+std::string optional_string(const char* s)
+{
+    return s != nullptr ? s : "";
+}
+
+} // namespace
+
+// No exception may cross into the caller's language: every entry point
+// reports failures through its return value instead.
+
+wordle_dictionary* wordle_dictionary_load(const char* path, const std::size_t num_threads, char* error,
+        const std::size_t error_size)
+{
+    try {
+        auto handle = std::make_unique<wordle_dictionary>();
+        std::ostringstream messages;
+        if (!handle->dictionary.load(optional_string(path), num_threads != 0 ? num_threads : default_thread_count(),
+                messages)) {
+            report_error(error_message(messages.str()), error, error_size);
+            return nullptr;
+        }
+        return handle.release();
+    } catch (const std::exception& ex) {
+        report_error(ex.what(), error, error_size);
+        return nullptr;
+    }
+}
+
+void wordle_dictionary_free(wordle_dictionary* dictionary)
+{
+    delete dictionary;
+}
+
+std::size_t wordle_dictionary_count(const wordle_dictionary* dictionary, const std::size_t length)
+{
+    return dictionary != nullptr ? dictionary->dictionary.words(length).count : 0;
+}
+
+const char* wordle_dictionary_word(const wordle_dictionary* dictionary, const std::size_t length,
+        const std::uint32_t index)
+{
+    if (dictionary == nullptr) {
+        return nullptr;
+    }
+    const WordTable words = dictionary->dictionary.words(length);
+    return index < words.count ? words.data + (index * words.length) : nullptr;
+}
+
+wordle_query* wordle_query_compile(const wordle_constraints* constraints, const std::size_t num_threads,
+        char* error, const std::size_t error_size)
+{
+    if (constraints == nullptr) {
+        report_error("No constraints given.", error, error_size);
+        return nullptr;
+    }
+    try {
+        set_solver::QueryConstraints values;
+        values.length = constraints->length != 0 ? constraints->length : set_solver::WORDLE_WORD_LEN;
+        values.exclude = optional_string(constraints->exclude);
+        values.require = optional_string(constraints->require);
+        values.known = optional_string(constraints->known);
+        values.count = optional_string(constraints->count);
+        for (std::size_t g = 0; g < constraints->num_guesses; g++) {
+            values.guesses.push_back(optional_string(constraints->guesses[g]));
+        }
+
+        auto handle = std::make_unique<wordle_query>();
+        std::ostringstream messages;
+        if (!set_solver::compile_query(values, num_threads != 0 ? num_threads : default_thread_count(), handle->query, messages)) {
+            report_error(error_message(messages.str()), error, error_size);
+            return nullptr;
+        }
+        return handle.release();
+    } catch (const std::exception& ex) {
+        report_error(ex.what(), error, error_size);
+        return nullptr;
+    }
+}
+
+void wordle_query_free(wordle_query* query)
+{
+    delete query;
+}
+
+std::size_t wordle_query_length(const wordle_query* query)
+{
+    return query != nullptr ? query->query.length : 0;
+}
+
+std::size_t wordle_filter(const wordle_dictionary* dictionary, const wordle_query* query, std::uint32_t* out,
+        const std::size_t capacity)
+{
+    if ((dictionary == nullptr) || (query == nullptr)) {
+        return 0;
+    }
+    try {
+        return set_solver::find_matches(dictionary->dictionary, query->query, out, out != nullptr ? capacity : 0);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}